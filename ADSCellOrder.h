@@ -0,0 +1,178 @@
+/****************************************************************************
+ *
+ * (C) 2021 Cadence Design Systems, Inc. All rights reserved worldwide.
+ *
+ * This sample source code is not supported by Cadence Design Systems, Inc.
+ * It is provided freely for demonstration purposes only.
+ * SEE THE WARRANTY DISCLAIMER AT THE BOTTOM OF THIS FILE.
+ *
+ ***************************************************************************/
+/****************************************************************************
+ *
+ * ADSCellOrder: Space-filling curve keys and a parallel radix sort
+ *
+ ***************************************************************************/
+
+#ifndef _ADSCELLORDER_H_
+#define _ADSCELLORDER_H_
+
+#include "apiPWP.h"
+#include "ADSOrderedPipeline.h"
+
+#include <algorithm>
+#include <vector>
+
+
+// Number of bits in each coordinate of a curve key
+const PWP_UINT32 AdsCurveBits = 21;
+
+
+// Spreads the low 21 bits of v so there are two zero bits between each of
+// them
+static inline PWP_UINT64
+adsSpreadBits3(PWP_UINT32 v)
+{
+    PWP_UINT64 x = v & 0x1FFFFF;
+    x = (x | (x << 32)) & 0x001F00000000FFFFull;
+    x = (x | (x << 16)) & 0x001F0000FF0000FFull;
+    x = (x | (x << 8)) & 0x100F00F00F00F00Full;
+    x = (x | (x << 4)) & 0x10C30C30C30C30C3ull;
+    x = (x | (x << 2)) & 0x1249249249249249ull;
+    return x;
+}
+
+
+// Position of the grid point (x, y, z) along a Morton (Z-order) curve. Each
+// coordinate has AdsCurveBits bits.
+static inline PWP_UINT64
+adsMortonKey(PWP_UINT32 x, PWP_UINT32 y, PWP_UINT32 z)
+{
+    return (adsSpreadBits3(z) << 2) | (adsSpreadBits3(y) << 1) |
+        adsSpreadBits3(x);
+}
+
+
+// Position of the grid point (x, y, z) along a Hilbert curve. Each
+// coordinate has AdsCurveBits bits. Uses J. Skilling's transform of the
+// coordinates ("Programming the Hilbert curve", 2004). Unlike the Morton
+// curve, consecutive points are always neighbors.
+static inline PWP_UINT64
+adsHilbertKey(PWP_UINT32 x, PWP_UINT32 y, PWP_UINT32 z)
+{
+    const int N = 3;
+    PWP_UINT32 X[N] = { x, y, z };
+    const PWP_UINT32 M = PWP_UINT32(1) << (AdsCurveBits - 1);
+    PWP_UINT32 t;
+    // Inverse undo. The bit tests are turned into masks. The branches they
+    // replace are unpredictable.
+    for (PWP_UINT32 Q = M; Q > 1; Q >>= 1) {
+        const PWP_UINT32 P = Q - 1;
+        for (int i = 0; i < N; ++i) {
+            const PWP_UINT32 set = 0u - PWP_UINT32(0 != (X[i] & Q));
+            t = (X[0] ^ X[i]) & P & ~set;
+            // invert if set, else exchange
+            X[0] ^= (P & set) | t;
+            X[i] ^= t;
+        }
+    }
+    // Gray encode
+    for (int i = 1; i < N; ++i) {
+        X[i] ^= X[i - 1];
+    }
+    t = 0;
+    for (PWP_UINT32 Q = M; Q > 1; Q >>= 1) {
+        t ^= (Q - 1) & (0u - PWP_UINT32(0 != (X[N - 1] & Q)));
+    }
+    for (int i = 0; i < N; ++i) {
+        X[i] ^= t;
+    }
+    // X[0] holds the most significant bit of each 3 bit digit
+    return (adsSpreadBits3(X[0]) << 2) | (adsSpreadBits3(X[1]) << 1) |
+        adsSpreadBits3(X[2]);
+}
+
+
+// Sorts the [beg, end) range of keys and vals by key. Equal keys keep their
+// order. LSD radix sort, one byte per pass. Each pass counts and scatters
+// the keys in chunks on the given number of threads. Passes where every key
+// has the same byte are skipped.
+static void
+adsRadixSort(std::vector<PWP_UINT64> &keys, std::vector<PWP_UINT32> &vals,
+    PWP_UINT32 beg, PWP_UINT32 end, unsigned threads)
+{
+    const PWP_UINT32 ChunkSize = 65536;
+    const PWP_UINT32 Bins = 256;
+    const PWP_UINT32 n = end - beg;
+    const PWP_UINT32 chunkCnt = (n + ChunkSize - 1) / ChunkSize;
+    if (n < 2) {
+        return;
+    }
+    PWP_UINT64 *key = &keys[beg];
+    PWP_UINT32 *val = &vals[beg];
+    std::vector<PWP_UINT64> keys2(n);
+    std::vector<PWP_UINT32> vals2(n);
+    PWP_UINT64 *key2 = &keys2[0];
+    PWP_UINT32 *val2 = &vals2[0];
+    std::vector<PWP_UINT32> offsets(size_t(chunkCnt) * Bins);
+    auto noProgress = [](PWP_UINT32) { return true; };
+    bool swapped = false;
+    for (int shift = 0; shift < 64; shift += 8) {
+        std::fill(offsets.begin(), offsets.end(), 0);
+        auto count = [&](PWP_UINT32 b, PWP_UINT32 e) {
+            PWP_UINT32 *cnt = &offsets[size_t(b / ChunkSize) * Bins];
+            for (PWP_UINT32 i = b; i < e; ++i) {
+                ++cnt[(key[i] >> shift) & 0xFF];
+            }
+            return true;
+        };
+        adsParallelFor(n, ChunkSize, threads, count, noProgress);
+        // The chunks of each bin go in chunk order so the sort is stable
+        PWP_UINT32 sum = 0;
+        bool skip = false;
+        for (PWP_UINT32 bin = 0; bin < Bins && !skip; ++bin) {
+            const PWP_UINT32 binBeg = sum;
+            for (PWP_UINT32 c = 0; c < chunkCnt; ++c) {
+                PWP_UINT32 &off = offsets[size_t(c) * Bins + bin];
+                const PWP_UINT32 cnt = off;
+                off = sum;
+                sum += cnt;
+            }
+            skip = (sum - binBeg == n);
+        }
+        if (skip) {
+            // every key is in one bin
+            continue;
+        }
+        auto scatter = [&](PWP_UINT32 b, PWP_UINT32 e) {
+            PWP_UINT32 *off = &offsets[size_t(b / ChunkSize) * Bins];
+            for (PWP_UINT32 i = b; i < e; ++i) {
+                const PWP_UINT32 d = off[(key[i] >> shift) & 0xFF]++;
+                key2[d] = key[i];
+                val2[d] = val[i];
+            }
+            return true;
+        };
+        adsParallelFor(n, ChunkSize, threads, scatter, noProgress);
+        std::swap(key, key2);
+        std::swap(val, val2);
+        swapped = !swapped;
+    }
+    if (swapped) {
+        // the result is in the scratch arrays
+        std::copy(key, key + n, key2);
+        std::copy(val, val + n, val2);
+    }
+}
+
+#endif /* _ADSCELLORDER_H_ */
+
+/****************************************************************************
+ *
+ * This file is licensed under the Cadence Public License Version 1.0 (the
+ * "License"), a copy of which is found in the included file named "LICENSE",
+ * and is distributed "AS IS." TO THE MAXIMUM EXTENT PERMITTED BY APPLICABLE
+ * LAW, CADENCE DISCLAIMS ALL WARRANTIES AND IN NO EVENT SHALL BE LIABLE TO
+ * ANY PARTY FOR ANY DAMAGES ARISING OUT OF OR RELATING TO USE OF THIS FILE.
+ * Please see the License for the full text of applicable terms.
+ *
+ ****************************************************************************/
@@ -0,0 +1,153 @@
+/****************************************************************************
+ *
+ * (C) 2021 Cadence Design Systems, Inc. All rights reserved worldwide.
+ *
+ * This sample source code is not supported by Cadence Design Systems, Inc.
+ * It is provided freely for demonstration purposes only.
+ * SEE THE WARRANTY DISCLAIMER AT THE BOTTOM OF THIS FILE.
+ *
+ ***************************************************************************/
+/****************************************************************************
+ *
+ * ADSFaceHash: Concurrent hash of polygon faces keyed by vertex indices
+ *
+ ***************************************************************************/
+
+#ifndef _ADSFACEHASH_H_
+#define _ADSFACEHASH_H_
+
+#include "apiPWP.h"
+
+#include <algorithm>
+#include <atomic>
+#include <vector>
+
+
+// Maps faces to the caller's record indices. A face's key is its sorted
+// vertex indices, so the same face matches whatever vertex order or
+// starting vertex each element uses for it.
+//
+// The table has a fixed number of records. insert() may be called from many
+// threads at the same time. Once all the inserts are done (and the inserting
+// threads are joined), find() may be called from many threads at the same
+// time. Equal keys are all kept.
+class ADSFaceHash {
+public:
+
+    enum {
+        // Max number of vertices in a face
+        MaxFaceVerts = 4
+    };
+
+    struct Key {
+        PWP_UINT32 v[MaxFaceVerts];
+
+        inline bool operator==(const Key &rhs) const
+        {
+            return v[0] == rhs.v[0] && v[1] == rhs.v[1] && v[2] == rhs.v[2] &&
+                v[3] == rhs.v[3];
+        }
+    };
+
+
+    // Sets key to the n (3 or 4) vertex indices at verts
+    static inline void makeKey(const PWP_UINT32 *verts, PWP_UINT32 n,
+        Key &key)
+    {
+        key.v[3] = PWP_UINT32(~0u);
+        for (PWP_UINT32 i = 0; i < n && i < PWP_UINT32(MaxFaceVerts); ++i) {
+            key.v[i] = verts[i];
+        }
+        std::sort(key.v, key.v + MaxFaceVerts);
+    }
+
+
+    // Sizes the table for recCnt records
+    ADSFaceHash(PWP_UINT32 recCnt) :
+        keys_(recCnt),
+        slots_(tableSize(recCnt)),
+        mask_(slots_.size() - 1)
+    {
+        for (size_t i = 0; i < slots_.size(); ++i) {
+            slots_[i].store(0, std::memory_order_relaxed);
+        }
+    }
+
+
+    // Adds record rec with key. Each record is inserted once.
+    void insert(PWP_UINT32 rec, const Key &key)
+    {
+        keys_[rec] = key;
+        size_t ndx = size_t(hash(key)) & mask_;
+        PWP_UINT32 empty = 0;
+        while (!slots_[ndx].compare_exchange_strong(empty, rec + 1,
+                std::memory_order_relaxed)) {
+            ndx = (ndx + 1) & mask_;
+            empty = 0;
+        }
+    }
+
+
+    // Calls func(rec) for each record inserted with key
+    template<typename Func>
+    void find(const Key &key, Func func) const
+    {
+        size_t ndx = size_t(hash(key)) & mask_;
+        PWP_UINT32 slot;
+        while (0 != (slot = slots_[ndx].load(std::memory_order_relaxed))) {
+            if (keys_[slot - 1] == key) {
+                func(slot - 1);
+            }
+            ndx = (ndx + 1) & mask_;
+        }
+    }
+
+
+private:
+
+    // Returns a power of 2 of at least twice recCnt, so probe runs stay short
+    // and there is always an empty slot.
+    static size_t tableSize(PWP_UINT32 recCnt)
+    {
+        size_t n = 16;
+        while (n < 2 * size_t(recCnt)) {
+            n *= 2;
+        }
+        return n;
+    }
+
+
+    static inline PWP_UINT64 hash(const Key &key)
+    {
+        PWP_UINT64 h = 0;
+        for (int i = 0; i < MaxFaceVerts; ++i) {
+            h = (h ^ key.v[i]) * 0x9E3779B97F4A7C15ull;
+        }
+        return h ^ (h >> 29);
+    }
+
+
+private:
+
+    // Key of each record
+    std::vector<Key>                        keys_;
+
+    // Record index + 1 of each slot or 0 if the slot is empty
+    std::vector<std::atomic<PWP_UINT32> >   slots_;
+
+    // Number of slots - 1
+    size_t                                  mask_;
+};
+
+#endif /* _ADSFACEHASH_H_ */
+
+/****************************************************************************
+ *
+ * This file is licensed under the Cadence Public License Version 1.0 (the
+ * "License"), a copy of which is found in the included file named "LICENSE",
+ * and is distributed "AS IS." TO THE MAXIMUM EXTENT PERMITTED BY APPLICABLE
+ * LAW, CADENCE DISCLAIMS ALL WARRANTIES AND IN NO EVENT SHALL BE LIABLE TO
+ * ANY PARTY FOR ANY DAMAGES ARISING OUT OF OR RELATING TO USE OF THIS FILE.
+ * Please see the License for the full text of applicable terms.
+ *
+ ****************************************************************************/
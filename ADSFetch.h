@@ -0,0 +1,312 @@
+/****************************************************************************
+ *
+ * (C) 2021 Cadence Design Systems, Inc. All rights reserved worldwide.
+ *
+ * This sample source code is not supported by Cadence Design Systems, Inc.
+ * It is provided freely for demonstration purposes only.
+ * SEE THE WARRANTY DISCLAIMER AT THE BOTTOM OF THIS FILE.
+ *
+ ***************************************************************************/
+/****************************************************************************
+ *
+ * ADSFetch: Structure-of-arrays batches of grid model vertices and elements
+ *           and the arena that holds them
+ *
+ ***************************************************************************/
+
+#ifndef _ADSFETCH_H_
+#define _ADSFETCH_H_
+
+#include "apiGridModel.h"
+#include "apiPWP.h"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+
+// Bump allocator for the arrays of one batch. reset() frees everything at
+// once and keeps the memory for the next batch, so a writer thread that
+// fetches batch after batch stops allocating after its first one. Each
+// thread has its own arena from local().
+class ADSArena {
+public:
+
+    enum {
+        // Alignment of every allocation. Enough for 256-bit vector loads.
+        Align = 32,
+
+        // Minimum size of each block of memory
+        BlockSize = 256 * 1024
+    };
+
+
+    ADSArena() :
+        blocks_(),
+        block_(0),
+        used_(0)
+    {
+    }
+
+
+    // Returns space for n values of type T. It is not initialized and stays
+    // valid until reset().
+    template<typename T>
+    T *alloc(size_t n)
+    {
+        const size_t size = (n * sizeof(T) + Align - 1) & ~size_t(Align - 1);
+        while (block_ < blocks_.size() && blocks_[block_].size() - Align <
+                used_ + size) {
+            // this block is full - move to the next one
+            ++block_;
+            used_ = 0;
+        }
+        if (block_ == blocks_.size()) {
+            blocks_.push_back(std::vector<char>());
+            blocks_.back().resize(std::max(size, size_t(BlockSize)) + Align);
+            used_ = 0;
+        }
+        std::vector<char> &block = blocks_[block_];
+        // offset of the first aligned byte of the block
+        const size_t start = (Align - size_t(block.data()) % Align) % Align;
+        char *p = block.data() + start + used_;
+        used_ += size;
+        return (T*)p;
+    }
+
+
+    // Frees all allocations
+    inline void reset()
+    {
+        block_ = 0;
+        used_ = 0;
+    }
+
+
+    // The calling thread's arena
+    static ADSArena &local()
+    {
+        static thread_local ADSArena arena;
+        return arena;
+    }
+
+
+private:
+
+    // Not copyable
+    ADSArena(const ADSArena &);
+    ADSArena &operator=(const ADSArena &);
+
+
+private:
+
+    // Memory blocks. Each has Align spare bytes for aligning its start.
+    std::vector<std::vector<char> > blocks_;
+
+    // Block being allocated from and the bytes used in it
+    size_t      block_;
+    size_t      used_;
+};
+
+
+// The XYZ of a contiguous range of REST vertices in separate arrays
+class ADSVertexBatch {
+public:
+
+    ADSVertexBatch() :
+        first_(0),
+        count_(0),
+        x_(0),
+        y_(0),
+        z_(0)
+    {
+    }
+
+
+    // Allocates the arrays for count vertices starting at REST position
+    // first
+    void init(ADSArena &arena, PWP_UINT32 first, PWP_UINT32 count)
+    {
+        first_ = first;
+        count_ = count;
+        x_ = arena.alloc<PWP_REAL>(count);
+        y_ = arena.alloc<PWP_REAL>(count);
+        z_ = arena.alloc<PWP_REAL>(count);
+    }
+
+
+    // Stores vertex i of the batch
+    inline void set(PWP_UINT32 i, const PWGM_VERTDATA &v)
+    {
+        x_[i] = v.x;
+        y_[i] = v.y;
+        z_[i] = v.z;
+    }
+
+
+    inline PWP_UINT32 getFirst() const
+    {
+        return first_;
+    }
+
+
+    inline PWP_UINT32 getCount() const
+    {
+        return count_;
+    }
+
+
+    inline const PWP_REAL *x() const
+    {
+        return x_;
+    }
+
+
+    inline const PWP_REAL *y() const
+    {
+        return y_;
+    }
+
+
+    inline const PWP_REAL *z() const
+    {
+        return z_;
+    }
+
+
+private:
+
+    // REST position of the first vertex and the number of vertices
+    PWP_UINT32  first_;
+    PWP_UINT32  count_;
+
+    // Coordinates of each vertex
+    PWP_REAL *  x_;
+    PWP_REAL *  y_;
+    PWP_REAL *  z_;
+};
+
+
+// A contiguous range of REST cells grouped by element type. Each type has a
+// flat array of its elements' model vertex indices and the position of each
+// of its elements in the batch, so every element of a group has the same
+// vertex count.
+class ADSElemBatch {
+public:
+
+    // The elements of one type
+    struct Group {
+        // Number of vertices of each element
+        PWP_UINT32      vertCnt;
+
+        // Number of elements
+        PWP_UINT32      count;
+
+        // vertCnt indices per element. There are PWGM_ELEMDATA_VERT_SIZE
+        // spare values after the last element, so 8 values can be loaded
+        // from the start of any element.
+        PWP_UINT32 *    index;
+
+        // Position (0..batch count - 1) of each element in the batch
+        PWP_UINT32 *    pos;
+    };
+
+
+    ADSElemBatch() :
+        arena_(0),
+        first_(0),
+        count_(0),
+        added_(0)
+    {
+        memset(groups_, 0, sizeof(groups_));
+    }
+
+
+    // Starts an empty batch for count cells starting at REST position first.
+    // The group arrays are allocated from arena as types are added.
+    void init(ADSArena &arena, PWP_UINT32 first, PWP_UINT32 count)
+    {
+        arena_ = &arena;
+        first_ = first;
+        count_ = count;
+        added_ = 0;
+        memset(groups_, 0, sizeof(groups_));
+    }
+
+
+    // Appends the next cell of the batch. Returns false if its type or
+    // vertex count is not valid or does not match the others of its type.
+    bool add(const PWGM_ELEMDATA &eData)
+    {
+        if (added_ >= count_ || PWP_UINT32(eData.type) >=
+                PWP_UINT32(PWGM_ELEMTYPE_SIZE) || 0 == eData.vertCnt ||
+                eData.vertCnt > PWGM_ELEMDATA_VERT_SIZE) {
+            return false;
+        }
+        Group &g = groups_[eData.type];
+        if (0 == g.index) {
+            g.vertCnt = eData.vertCnt;
+            g.index = arena_->alloc<PWP_UINT32>(size_t(count_) *
+                eData.vertCnt + PWGM_ELEMDATA_VERT_SIZE);
+            g.pos = arena_->alloc<PWP_UINT32>(count_);
+            // the spare values are loaded but never used
+            memset(g.index + size_t(count_) * eData.vertCnt, 0,
+                PWGM_ELEMDATA_VERT_SIZE * sizeof(PWP_UINT32));
+        }
+        else if (g.vertCnt != eData.vertCnt) {
+            return false;
+        }
+        memcpy(g.index + size_t(g.count) * g.vertCnt, eData.index,
+            g.vertCnt * sizeof(PWP_UINT32));
+        g.pos[g.count++] = added_++;
+        return true;
+    }
+
+
+    inline PWP_UINT32 getFirst() const
+    {
+        return first_;
+    }
+
+
+    inline PWP_UINT32 getCount() const
+    {
+        return count_;
+    }
+
+
+    // The elements of type t. Its count is 0 if the batch has none.
+    inline const Group &group(int t) const
+    {
+        return groups_[t];
+    }
+
+
+private:
+
+    // Arena the group arrays come from
+    ADSArena *  arena_;
+
+    // REST position of the first cell and the number of cells
+    PWP_UINT32  first_;
+    PWP_UINT32  count_;
+
+    // Number of cells added so far
+    PWP_UINT32  added_;
+
+    // The elements of each type
+    Group       groups_[PWGM_ELEMTYPE_SIZE];
+};
+
+#endif /* _ADSFETCH_H_ */
+
+/****************************************************************************
+ *
+ * This file is licensed under the Cadence Public License Version 1.0 (the
+ * "License"), a copy of which is found in the included file named "LICENSE",
+ * and is distributed "AS IS." TO THE MAXIMUM EXTENT PERMITTED BY APPLICABLE
+ * LAW, CADENCE DISCLAIMS ALL WARRANTIES AND IN NO EVENT SHALL BE LIABLE TO
+ * ANY PARTY FOR ANY DAMAGES ARISING OUT OF OR RELATING TO USE OF THIS FILE.
+ * Please see the License for the full text of applicable terms.
+ *
+ ****************************************************************************/
@@ -0,0 +1,325 @@
+/****************************************************************************
+ *
+ * (C) 2021 Cadence Design Systems, Inc. All rights reserved worldwide.
+ *
+ * This sample source code is not supported by Cadence Design Systems, Inc.
+ * It is provided freely for demonstration purposes only.
+ * SEE THE WARRANTY DISCLAIMER AT THE BOTTOM OF THIS FILE.
+ *
+ ***************************************************************************/
+/****************************************************************************
+ *
+ * ADSGzipWriter: Block-parallel gzip compression of REST output
+ *
+ ***************************************************************************/
+
+#ifndef _ADSGZIPWRITER_H_
+#define _ADSGZIPWRITER_H_
+
+// zlib is optional. Build with ADS_USE_ZLIB defined and link with zlib to
+// enable compressed REST output.
+#if defined(ADS_USE_ZLIB)
+
+#include "apiPWP.h"
+#include "pwpPlatform.h"
+
+#include "ADSWriteBuffer.h"
+
+#include <zlib.h>
+
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+// Splits the data written to it into fixed size blocks and compresses each
+// block on a pool of worker threads. Every block becomes a complete gzip
+// member and the members are written to the file in order. A file of
+// concatenated members is a valid gzip file that gunzip, zcat and zlib's
+// gzread() read as one stream.
+//
+// With 1 thread, blocks are compressed on the calling thread.
+class ADSGzipWriter : public ADSWriteSink {
+public:
+
+    enum {
+        // Uncompressed bytes in each gzip member
+        DefaultBlockSize = 4 * 1024 * 1024
+    };
+
+
+    ADSGzipWriter(FILE *fp, unsigned threads, int level = Z_BEST_SPEED,
+            size_t blockSize = DefaultBlockSize) :
+        fp_(fp),
+        level_(level),
+        blockSize_(0 == blockSize ? size_t(DefaultBlockSize) : blockSize),
+        maxQueued_(2 * (threads < 1 ? 1 : threads)),
+        cur_(),
+        blocks_(),
+        free_(),
+        queue_(),
+        todo_(),
+        mtx_(),
+        cv_(),
+        workers_(),
+        stop_(false),
+        ok_(0 != fp),
+        in_(0),
+        out_(0)
+    {
+        cur_.reserve(blockSize_);
+        for (unsigned i = 0; threads > 1 && i < threads; ++i) {
+            workers_.push_back(std::thread(&ADSGzipWriter::work, this));
+        }
+    }
+
+    ~ADSGzipWriter()
+    {
+        close();
+    }
+
+
+    virtual bool write(const void *data, size_t n)
+    {
+        const char *p = (const char*)data;
+        while (0 != n && ok_) {
+            size_t cnt = blockSize_ - cur_.size();
+            if (cnt > n) {
+                cnt = n;
+            }
+            cur_.insert(cur_.end(), p, p + cnt);
+            p += cnt;
+            n -= cnt;
+            in_ += cnt;
+            if (blockSize_ == cur_.size()) {
+                submit();
+            }
+        }
+        return ok_;
+    }
+
+
+    // Compresses and writes any remaining data and stops the worker threads.
+    // Returns false if any block could not be compressed or written.
+    bool close()
+    {
+        if (!cur_.empty()) {
+            submit();
+        }
+        drain(true);
+        {
+            std::lock_guard<std::mutex> lock(mtx_);
+            stop_ = true;
+        }
+        cv_.notify_all();
+        for (size_t i = 0; i < workers_.size(); ++i) {
+            workers_[i].join();
+        }
+        workers_.clear();
+        fp_ = 0;
+        return ok_;
+    }
+
+
+    // Number of uncompressed bytes written to the writer so far
+    inline PWP_UINT64 bytesIn() const
+    {
+        return in_;
+    }
+
+
+    // Number of compressed bytes written to the file so far
+    inline PWP_UINT64 bytesOut() const
+    {
+        return out_;
+    }
+
+
+private:
+
+    struct Block {
+        std::vector<char>   in;
+        std::vector<char>   out;
+        bool                done;
+        bool                ok;
+    };
+
+
+    // Compresses b.in into a gzip member in b.out
+    static bool compress(Block &b, int level)
+    {
+        z_stream zs;
+        memset(&zs, 0, sizeof(zs));
+        // 16 + 15 window bits selects the gzip wrapper
+        if (Z_OK != deflateInit2(&zs, level, Z_DEFLATED, 16 + 15, 8,
+                Z_DEFAULT_STRATEGY)) {
+            return false;
+        }
+        b.out.resize(deflateBound(&zs, uLong(b.in.size())));
+        zs.next_in = (Bytef*)b.in.data();
+        zs.avail_in = uInt(b.in.size());
+        zs.next_out = (Bytef*)b.out.data();
+        zs.avail_out = uInt(b.out.size());
+        const bool ret = (Z_STREAM_END == deflate(&zs, Z_FINISH));
+        b.out.resize(zs.total_out);
+        deflateEnd(&zs);
+        return ret;
+    }
+
+
+    // Queues the current block for compression
+    void submit()
+    {
+        Block *b;
+        if (free_.empty()) {
+            blocks_.push_back(std::unique_ptr<Block>(new Block));
+            b = blocks_.back().get();
+        }
+        else {
+            b = free_.back();
+            free_.pop_back();
+        }
+        b->in.swap(cur_);
+        cur_.clear();
+        cur_.reserve(blockSize_);
+        b->done = false;
+        b->ok = false;
+        queue_.push_back(b);
+        if (workers_.empty()) {
+            b->ok = compress(*b, level_);
+            b->done = true;
+        }
+        else {
+            {
+                std::lock_guard<std::mutex> lock(mtx_);
+                todo_.push_back(b);
+            }
+            cv_.notify_all();
+        }
+        drain(false);
+    }
+
+
+    // Writes the compressed blocks at the front of the queue. Waits for the
+    // oldest block if all is true or if too many blocks are queued.
+    void drain(bool all)
+    {
+        while (!queue_.empty()) {
+            Block *b = queue_.front();
+            {
+                std::unique_lock<std::mutex> lock(mtx_);
+                if (!b->done && !all && queue_.size() < maxQueued_) {
+                    break;
+                }
+                cv_.wait(lock, [&]() { return b->done; });
+            }
+            queue_.pop_front();
+            if (!ok_ || !b->ok || 0 == fp_ ||
+                    b->out.size() != pwpFileWrite(b->out.data(), 1,
+                        b->out.size(), fp_)) {
+                ok_ = false;
+            }
+            else {
+                out_ += b->out.size();
+            }
+            free_.push_back(b);
+        }
+    }
+
+
+    // Worker thread loop
+    void work()
+    {
+        for (;;) {
+            Block *b;
+            {
+                std::unique_lock<std::mutex> lock(mtx_);
+                cv_.wait(lock, [&]() { return stop_ || !todo_.empty(); });
+                if (todo_.empty()) {
+                    return;
+                }
+                b = todo_.front();
+                todo_.pop_front();
+            }
+            const bool ok = compress(*b, level_);
+            {
+                std::lock_guard<std::mutex> lock(mtx_);
+                b->ok = ok;
+                b->done = true;
+            }
+            cv_.notify_all();
+        }
+    }
+
+
+private:
+
+    // Not copyable
+    ADSGzipWriter(const ADSGzipWriter &);
+    ADSGzipWriter &operator=(const ADSGzipWriter &);
+
+
+private:
+
+    // Destination file
+    FILE *                              fp_;
+
+    // zlib compression level
+    int                                 level_;
+
+    // Uncompressed bytes in each block
+    size_t                              blockSize_;
+
+    // Max number of blocks waiting to be compressed or written
+    size_t                              maxQueued_;
+
+    // Block being filled by write()
+    std::vector<char>                   cur_;
+
+    // All blocks and the blocks not in use
+    std::vector<std::unique_ptr<Block> > blocks_;
+    std::vector<Block*>                 free_;
+
+    // Blocks waiting to be written, in file order. Only used by the calling
+    // thread.
+    std::deque<Block*>                  queue_;
+
+    // Blocks waiting for a worker thread
+    std::deque<Block*>                  todo_;
+
+    // Guards todo_, stop_ and the done and ok flags of the blocks
+    std::mutex                          mtx_;
+    std::condition_variable             cv_;
+
+    std::vector<std::thread>            workers_;
+
+    // Set to true to stop the worker threads
+    bool                                stop_;
+
+    // Set to false if a block could not be compressed or written
+    bool                                ok_;
+
+    // Uncompressed and compressed byte counts
+    PWP_UINT64                          in_;
+    PWP_UINT64                          out_;
+};
+
+#endif /* ADS_USE_ZLIB */
+
+#endif /* _ADSGZIPWRITER_H_ */
+
+/****************************************************************************
+ *
+ * This file is licensed under the Cadence Public License Version 1.0 (the
+ * "License"), a copy of which is found in the included file named "LICENSE",
+ * and is distributed "AS IS." TO THE MAXIMUM EXTENT PERMITTED BY APPLICABLE
+ * LAW, CADENCE DISCLAIMS ALL WARRANTIES AND IN NO EVENT SHALL BE LIABLE TO
+ * ANY PARTY FOR ANY DAMAGES ARISING OUT OF OR RELATING TO USE OF THIS FILE.
+ * Please see the License for the full text of applicable terms.
+ *
+ ****************************************************************************/
@@ -0,0 +1,240 @@
+/****************************************************************************
+ *
+ * (C) 2021 Cadence Design Systems, Inc. All rights reserved worldwide.
+ *
+ * This sample source code is not supported by Cadence Design Systems, Inc.
+ * It is provided freely for demonstration purposes only.
+ * SEE THE WARRANTY DISCLAIMER AT THE BOTTOM OF THIS FILE.
+ *
+ ***************************************************************************/
+/****************************************************************************
+ *
+ * ADSMappedFile: Preallocated, memory-mapped output file and read-only
+ *                input file
+ *
+ ***************************************************************************/
+
+#ifndef _ADSMAPPEDFILE_H_
+#define _ADSMAPPEDFILE_H_
+
+#include "apiPWP.h"
+
+#if defined(_WIN32)
+#   if !defined(NOMINMAX)
+#       define NOMINMAX
+#   endif
+#   include <windows.h>
+#else
+#   include <fcntl.h>
+#   include <sys/mman.h>
+#   include <sys/stat.h>
+#   include <unistd.h>
+#endif
+
+
+// Creates a file of an exact, known size and maps all of it into memory for
+// writing. Threads can then fill any part of the file directly. An existing
+// file can also be mapped for reading, so threads can parse any part of it
+// without seeking.
+class ADSMappedFile {
+public:
+
+    ADSMappedFile() :
+#if defined(_WIN32)
+        file_(INVALID_HANDLE_VALUE),
+        mapping_(0),
+#else
+        fd_(-1),
+#endif
+        data_(0),
+        size_(0),
+        readOnly_(false)
+    {
+    }
+
+    ~ADSMappedFile()
+    {
+        close();
+    }
+
+
+    // Creates (or truncates) fileName, sets its size to size bytes and maps
+    // it. Returns false on failure.
+    bool open(const char *fileName, PWP_UINT64 size)
+    {
+        close();
+        if (0 == size || PWP_UINT64(size_t(size)) != size) {
+            return false;
+        }
+#if defined(_WIN32)
+        file_ = CreateFileA(fileName, GENERIC_READ | GENERIC_WRITE, 0, 0,
+            CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, 0);
+        if (INVALID_HANDLE_VALUE == file_) {
+            return false;
+        }
+        mapping_ = CreateFileMappingA(file_, 0, PAGE_READWRITE,
+            DWORD(size >> 32), DWORD(size & 0xFFFFFFFF), 0);
+        if (0 != mapping_) {
+            data_ = (char*)MapViewOfFile(mapping_, FILE_MAP_WRITE, 0, 0,
+                size_t(size));
+        }
+#else
+        fd_ = ::open(fileName, O_RDWR | O_CREAT | O_TRUNC, 0666);
+        if (-1 == fd_) {
+            return false;
+        }
+        bool sized = false;
+#   if defined(__linux__)
+        // Reserve the blocks up front. Not all file systems support this.
+        sized = (0 == posix_fallocate(fd_, 0, off_t(size)));
+#   endif
+        if (!sized) {
+            sized = (0 == ftruncate(fd_, off_t(size)));
+        }
+        if (sized) {
+            void *p = mmap(0, size_t(size), PROT_READ | PROT_WRITE,
+                MAP_SHARED, fd_, 0);
+            data_ = (MAP_FAILED == p) ? 0 : (char*)p;
+        }
+#endif
+        if (0 == data_) {
+            close();
+            return false;
+        }
+        size_ = size;
+        return true;
+    }
+
+
+    // Maps all of the existing file fileName for reading. Returns false on
+    // failure or if the file is empty.
+    bool openRead(const char *fileName)
+    {
+        close();
+        PWP_UINT64 size = 0;
+#if defined(_WIN32)
+        file_ = CreateFileA(fileName, GENERIC_READ, FILE_SHARE_READ, 0,
+            OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, 0);
+        if (INVALID_HANDLE_VALUE == file_) {
+            return false;
+        }
+        LARGE_INTEGER fileSize;
+        if (GetFileSizeEx(file_, &fileSize)) {
+            size = PWP_UINT64(fileSize.QuadPart);
+        }
+        if (0 != size && PWP_UINT64(size_t(size)) == size) {
+            mapping_ = CreateFileMappingA(file_, 0, PAGE_READONLY, 0, 0, 0);
+        }
+        if (0 != mapping_) {
+            data_ = (char*)MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0);
+        }
+#else
+        fd_ = ::open(fileName, O_RDONLY);
+        if (-1 == fd_) {
+            return false;
+        }
+        struct stat st;
+        if (0 == fstat(fd_, &st)) {
+            size = PWP_UINT64(st.st_size);
+        }
+        if (0 != size && PWP_UINT64(size_t(size)) == size) {
+            void *p = mmap(0, size_t(size), PROT_READ, MAP_SHARED, fd_, 0);
+            data_ = (MAP_FAILED == p) ? 0 : (char*)p;
+        }
+#endif
+        if (0 == data_) {
+            close();
+            return false;
+        }
+        size_ = size;
+        readOnly_ = true;
+        return true;
+    }
+
+
+    // Unmaps and closes the file. Returns false if the data could not be
+    // committed to the file.
+    bool close()
+    {
+        bool ret = true;
+#if defined(_WIN32)
+        if (0 != data_) {
+            ret = readOnly_ || (0 != FlushViewOfFile(data_, 0));
+            UnmapViewOfFile(data_);
+        }
+        if (0 != mapping_) {
+            CloseHandle(mapping_);
+            mapping_ = 0;
+        }
+        if (INVALID_HANDLE_VALUE != file_) {
+            CloseHandle(file_);
+            file_ = INVALID_HANDLE_VALUE;
+        }
+#else
+        if (0 != data_) {
+            ret = (0 == munmap(data_, size_t(size_)));
+        }
+        if (-1 != fd_) {
+            ret = (0 == ::close(fd_)) && ret;
+            fd_ = -1;
+        }
+#endif
+        data_ = 0;
+        size_ = 0;
+        readOnly_ = false;
+        return ret;
+    }
+
+
+    inline char *data() const
+    {
+        return data_;
+    }
+
+
+    inline PWP_UINT64 size() const
+    {
+        return size_;
+    }
+
+
+private:
+
+    // Not copyable
+    ADSMappedFile(const ADSMappedFile &);
+    ADSMappedFile &operator=(const ADSMappedFile &);
+
+
+private:
+
+#if defined(_WIN32)
+    // File and file mapping handles
+    HANDLE      file_;
+    HANDLE      mapping_;
+#else
+    // File descriptor
+    int         fd_;
+#endif
+
+    // Start of the mapped file data
+    char *      data_;
+
+    // Size of the file and mapping in bytes
+    PWP_UINT64  size_;
+
+    // Set if the file was mapped by openRead()
+    bool        readOnly_;
+};
+
+#endif /* _ADSMAPPEDFILE_H_ */
+
+/****************************************************************************
+ *
+ * This file is licensed under the Cadence Public License Version 1.0 (the
+ * "License"), a copy of which is found in the included file named "LICENSE",
+ * and is distributed "AS IS." TO THE MAXIMUM EXTENT PERMITTED BY APPLICABLE
+ * LAW, CADENCE DISCLAIMS ALL WARRANTIES AND IN NO EVENT SHALL BE LIABLE TO
+ * ANY PARTY FOR ANY DAMAGES ARISING OUT OF OR RELATING TO USE OF THIS FILE.
+ * Please see the License for the full text of applicable terms.
+ *
+ ****************************************************************************/
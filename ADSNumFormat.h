@@ -0,0 +1,136 @@
+/****************************************************************************
+ *
+ * (C) 2021 Cadence Design Systems, Inc. All rights reserved worldwide.
+ *
+ * This sample source code is not supported by Cadence Design Systems, Inc.
+ * It is provided freely for demonstration purposes only.
+ * SEE THE WARRANTY DISCLAIMER AT THE BOTTOM OF THIS FILE.
+ *
+ ***************************************************************************/
+/****************************************************************************
+ *
+ * ADSNumFormat: Fixed-width ASCII number formatting for REST output
+ *
+ ***************************************************************************/
+
+#ifndef _ADSNUMFORMAT_H_
+#define _ADSNUMFORMAT_H_
+
+#include "apiPWP.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+
+// Max chars produced by one call to fmtUInt() or fmtFloat() not counting
+// any field width padding.
+const size_t MaxFmtFldLen = 64;
+
+
+// Writes the digits of v (no sign, no padding) backwards ending at end.
+// Returns a pointer to the first digit.
+static inline char *
+digitsRev(char *end, PWP_UINT64 v)
+{
+    static const char pairs[] =
+        "00010203040506070809101112131415161718192021222324252627282930313233"
+        "34353637383940414243444546474849505152535455565758596061626364656667"
+        "6869707172737475767778798081828384858687888990919293949596979899";
+    char *p = end;
+    while (v >= 100) {
+        const unsigned n = unsigned(v % 100) * 2;
+        v /= 100;
+        *--p = pairs[n + 1];
+        *--p = pairs[n];
+    }
+    if (v >= 10) {
+        const unsigned n = unsigned(v) * 2;
+        *--p = pairs[n + 1];
+        *--p = pairs[n];
+    }
+    else {
+        *--p = char('0' + v);
+    }
+    return p;
+}
+
+
+// Copies the len chars at src to dst right-justified in a field of width
+// fldWd. Returns a pointer just past the last char written.
+static inline char *
+padRight(char *dst, const char *src, size_t len, int fldWd)
+{
+    if (fldWd > 0 && size_t(fldWd) > len) {
+        const size_t pad = size_t(fldWd) - len;
+        memset(dst, ' ', pad);
+        dst += pad;
+    }
+    memcpy(dst, src, len);
+    return dst + len;
+}
+
+
+// Same output as sprintf(dst, "%*lu", fldWd, v)
+static inline char *
+fmtUInt(char *dst, PWP_UINT64 v, int fldWd = 1)
+{
+    char tmp[24];
+    char *end = tmp + sizeof(tmp);
+    const char *p = digitsRev(end, v);
+    return padRight(dst, p, size_t(end - p), fldWd);
+}
+
+
+// Same output as sprintf(dst, "%9f", v)
+static inline char *
+fmtFloat(char *dst, float v)
+{
+    const int FldWd = 9;
+    // A float's 24 bit mantissa times the 14 significant bits of 10^6 fits
+    // in a double's mantissa. So, v * 10^6 is exact and rounding it to an
+    // integer gives the same correctly rounded result as printf. Values too
+    // large for 64 bits and non-finite values are left to sprintf.
+    const double scaled = double(v) * 1.0e6;
+    if (!(std::fabs(scaled) < 9.0e18)) {
+        return dst + sprintf(dst, "%9f", v);
+    }
+    const PWP_UINT64 u = PWP_UINT64(std::fabs(std::nearbyint(scaled)));
+    char tmp[32];
+    char *end = tmp + sizeof(tmp);
+    char *p = end - 6;
+    // fraction: exactly 6 digits with leading zeros
+    PWP_UINT64 frac = u % 1000000;
+    for (int i = 5; i >= 0; --i) {
+        p[i] = char('0' + frac % 10);
+        frac /= 10;
+    }
+    *--p = '.';
+    p = digitsRev(p, u / 1000000);
+    if (std::signbit(v)) {
+        *--p = '-';
+    }
+    return padRight(dst, p, size_t(end - p), FldWd);
+}
+
+
+// Same output as sprintf(dst, "%24.16e", v). 17 significant digits, so the
+// value reads back exactly. Only ASCII double precision exports use this.
+static inline char *
+fmtDouble(char *dst, double v)
+{
+    return dst + sprintf(dst, "%24.16e", v);
+}
+
+#endif /* _ADSNUMFORMAT_H_ */
+
+/****************************************************************************
+ *
+ * This file is licensed under the Cadence Public License Version 1.0 (the
+ * "License"), a copy of which is found in the included file named "LICENSE",
+ * and is distributed "AS IS." TO THE MAXIMUM EXTENT PERMITTED BY APPLICABLE
+ * LAW, CADENCE DISCLAIMS ALL WARRANTIES AND IN NO EVENT SHALL BE LIABLE TO
+ * ANY PARTY FOR ANY DAMAGES ARISING OUT OF OR RELATING TO USE OF THIS FILE.
+ * Please see the License for the full text of applicable terms.
+ *
+ ****************************************************************************/
@@ -0,0 +1,282 @@
+/****************************************************************************
+ *
+ * (C) 2021 Cadence Design Systems, Inc. All rights reserved worldwide.
+ *
+ * This sample source code is not supported by Cadence Design Systems, Inc.
+ * It is provided freely for demonstration purposes only.
+ * SEE THE WARRANTY DISCLAIMER AT THE BOTTOM OF THIS FILE.
+ *
+ ***************************************************************************/
+/****************************************************************************
+ *
+ * ADSOrderedPipeline: Parallel chunk processing with optional in-order
+ *                     emission
+ *
+ ***************************************************************************/
+
+#ifndef _ADSORDEREDPIPELINE_H_
+#define _ADSORDEREDPIPELINE_H_
+
+#include "apiPWP.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+// Number of chunks of chunkSize items needed for total items. Computed in 64
+// bits, so totals up to 0xFFFFFFFF do not wrap.
+static inline PWP_UINT32
+adsChunkCount(PWP_UINT32 total, PWP_UINT32 chunkSize)
+{
+    return PWP_UINT32((PWP_UINT64(total) + chunkSize - 1) / chunkSize);
+}
+
+
+// Sets [beg, end) to the items of chunk c of the range [0, total)
+static inline void
+adsChunkRange(PWP_UINT32 c, PWP_UINT32 total, PWP_UINT32 chunkSize,
+    PWP_UINT32 &beg, PWP_UINT32 &end)
+{
+    const PWP_UINT64 b = PWP_UINT64(c) * chunkSize;
+    beg = PWP_UINT32(b);
+    end = PWP_UINT32(std::min(PWP_UINT64(total), b + chunkSize));
+}
+
+
+// Calls func(begin, count) for consecutive batches of at most batchSize
+// items of the range [beg, end). The loop steps by the batch's count, so it
+// ends even when end is close to 0xFFFFFFFF. Returns false as soon as func()
+// does.
+template<typename BatchFunc>
+bool
+adsForBatches(PWP_UINT32 beg, PWP_UINT32 end, PWP_UINT32 batchSize,
+    BatchFunc func)
+{
+    PWP_UINT32 n;
+    for (PWP_UINT32 b = beg; b < end; b += n) {
+        n = std::min(batchSize, end - b);
+        if (!func(b, n)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+// Splits the item range [0, total) into chunks of chunkSize items. Worker
+// threads call fill(begin, end, buf) to convert one chunk into buf. The
+// calling thread passes the filled buffers to emit(begin, end, buf) strictly
+// in chunk order. At most 2 * threads chunks are in flight at any time.
+//
+// fill() and emit() return false to stop the pipeline. Returns true if every
+// chunk was filled and emitted.
+template<typename Buffer, typename FillFunc, typename EmitFunc>
+bool
+adsRunOrdered(PWP_UINT32 total, PWP_UINT32 chunkSize, unsigned threads,
+    FillFunc fill, EmitFunc emit)
+{
+    if (0 == chunkSize) {
+        chunkSize = 1;
+    }
+    const PWP_UINT32 chunkCnt = adsChunkCount(total, chunkSize);
+    if (threads < 1) {
+        threads = 1;
+    }
+    if (threads > chunkCnt) {
+        threads = (0 == chunkCnt) ? 1 : unsigned(chunkCnt);
+    }
+
+    struct Slot {
+        Buffer      buf;
+        PWP_UINT64  chunk;
+        bool        ready;
+    };
+    const PWP_UINT32 slotCnt = 2 * threads;
+    std::vector<Slot> slots(slotCnt);
+    for (PWP_UINT32 i = 0; i < slotCnt; ++i) {
+        // slot i is first used by chunk i
+        slots[i].chunk = i;
+        slots[i].ready = false;
+    }
+
+    std::mutex mtx;
+    std::condition_variable cv;
+    // 64 bits, so the extra increments past the last chunk cannot wrap
+    std::atomic<PWP_UINT64> nextChunk(0);
+    std::atomic<bool> stop(false);
+
+    auto work = [&]() {
+        PWP_UINT64 c;
+        while (!stop && (c = nextChunk++) < chunkCnt) {
+            Slot &slot = slots[PWP_UINT32(c % slotCnt)];
+            {
+                // wait for the emitter to release the slot
+                std::unique_lock<std::mutex> lock(mtx);
+                cv.wait(lock, [&]() { return stop || slot.chunk == c; });
+            }
+            if (stop) {
+                break;
+            }
+            PWP_UINT32 beg;
+            PWP_UINT32 end;
+            adsChunkRange(PWP_UINT32(c), total, chunkSize, beg, end);
+            const bool ok = fill(beg, end, slot.buf);
+            {
+                std::lock_guard<std::mutex> lock(mtx);
+                if (ok) {
+                    slot.ready = true;
+                }
+                else {
+                    stop = true;
+                }
+            }
+            cv.notify_all();
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (unsigned i = 0; i < threads; ++i) {
+        workers.push_back(std::thread(work));
+    }
+
+    bool ret = true;
+    for (PWP_UINT32 c = 0; c < chunkCnt; ++c) {
+        Slot &slot = slots[c % slotCnt];
+        {
+            std::unique_lock<std::mutex> lock(mtx);
+            cv.wait(lock, [&]() { return stop || slot.ready; });
+            if (!slot.ready) {
+                // a worker failed
+                ret = false;
+                break;
+            }
+        }
+        PWP_UINT32 beg;
+        PWP_UINT32 end;
+        adsChunkRange(c, total, chunkSize, beg, end);
+        const bool ok = emit(beg, end, slot.buf);
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            slot.ready = false;
+            slot.chunk = PWP_UINT64(c) + slotCnt;
+            if (!ok) {
+                stop = true;
+                ret = false;
+            }
+        }
+        cv.notify_all();
+        if (!ret) {
+            break;
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        stop = true;
+    }
+    cv.notify_all();
+    for (size_t i = 0; i < workers.size(); ++i) {
+        workers[i].join();
+    }
+    return ret;
+}
+
+
+// Splits the item range [0, total) into chunks of chunkSize items. Worker
+// threads call work(begin, end) for each chunk in no particular order. The
+// calling thread calls progress(items) as chunks complete.
+//
+// work() and progress() return false to stop the loop. Returns true if every
+// chunk was completed.
+template<typename WorkFunc, typename ProgressFunc>
+bool
+adsParallelFor(PWP_UINT32 total, PWP_UINT32 chunkSize, unsigned threads,
+    WorkFunc work, ProgressFunc progress)
+{
+    if (0 == chunkSize) {
+        chunkSize = 1;
+    }
+    const PWP_UINT32 chunkCnt = adsChunkCount(total, chunkSize);
+    if (threads < 1) {
+        threads = 1;
+    }
+    if (threads > chunkCnt) {
+        threads = (0 == chunkCnt) ? 1 : unsigned(chunkCnt);
+    }
+
+    std::mutex mtx;
+    std::condition_variable cv;
+    // 64 bits, so the extra increments past the last chunk cannot wrap
+    std::atomic<PWP_UINT64> nextChunk(0);
+    std::atomic<bool> stop(false);
+    PWP_UINT32 doneItems = 0;
+    PWP_UINT32 doneChunks = 0;
+
+    auto run = [&]() {
+        PWP_UINT64 c;
+        while (!stop && (c = nextChunk++) < chunkCnt) {
+            PWP_UINT32 beg;
+            PWP_UINT32 end;
+            adsChunkRange(PWP_UINT32(c), total, chunkSize, beg, end);
+            const bool ok = work(beg, end);
+            {
+                std::lock_guard<std::mutex> lock(mtx);
+                if (ok) {
+                    doneItems += end - beg;
+                    ++doneChunks;
+                }
+                else {
+                    stop = true;
+                }
+            }
+            cv.notify_all();
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (unsigned i = 0; i < threads; ++i) {
+        workers.push_back(std::thread(run));
+    }
+
+    PWP_UINT32 reported = 0;
+    bool done = (0 == chunkCnt);
+    while (!done) {
+        PWP_UINT32 items;
+        {
+            std::unique_lock<std::mutex> lock(mtx);
+            cv.wait(lock, [&]() {
+                return stop || doneItems > reported || doneChunks == chunkCnt;
+            });
+            items = doneItems - reported;
+            reported = doneItems;
+            done = stop || doneChunks == chunkCnt;
+        }
+        if (0 != items && !progress(items)) {
+            std::lock_guard<std::mutex> lock(mtx);
+            stop = true;
+            done = true;
+        }
+    }
+
+    for (size_t i = 0; i < workers.size(); ++i) {
+        workers[i].join();
+    }
+    return !stop && doneChunks == chunkCnt;
+}
+
+#endif /* _ADSORDEREDPIPELINE_H_ */
+
+/****************************************************************************
+ *
+ * This file is licensed under the Cadence Public License Version 1.0 (the
+ * "License"), a copy of which is found in the included file named "LICENSE",
+ * and is distributed "AS IS." TO THE MAXIMUM EXTENT PERMITTED BY APPLICABLE
+ * LAW, CADENCE DISCLAIMS ALL WARRANTIES AND IN NO EVENT SHALL BE LIABLE TO
+ * ANY PARTY FOR ANY DAMAGES ARISING OUT OF OR RELATING TO USE OF THIS FILE.
+ * Please see the License for the full text of applicable terms.
+ *
+ ****************************************************************************/
@@ -0,0 +1,234 @@
+/****************************************************************************
+ *
+ * (C) 2021 Cadence Design Systems, Inc. All rights reserved worldwide.
+ *
+ * This sample source code is not supported by Cadence Design Systems, Inc.
+ * It is provided freely for demonstration purposes only.
+ * SEE THE WARRANTY DISCLAIMER AT THE BOTTOM OF THIS FILE.
+ *
+ ***************************************************************************/
+/****************************************************************************
+ *
+ * ADSPartition: Recursive coordinate bisection and local numbering of the
+ *               REST partitions
+ *
+ ***************************************************************************/
+
+#ifndef _ADSPARTITION_H_
+#define _ADSPARTITION_H_
+
+#include "apiPWP.h"
+
+#include <algorithm>
+#include <vector>
+
+
+// Splits a set of cells into parts of nearly equal size by recursive
+// coordinate bisection (RCB) of their centroids. Each cut is made across the
+// longest side of the bounding box of the cells being split. A range of n
+// parts is split into n / 2 and n - n / 2 parts with a proportional number
+// of cells, so any part count is supported, not just powers of 2.
+//
+// Cells with equal coordinates are ordered by index, so the same centroids
+// always give the same parts.
+class ADSPartition {
+public:
+
+    typedef std::vector<PWP_UINT32> UINT32Vec;
+    typedef std::vector<float>      FloatVec;
+
+
+    // centroids holds the XYZ of each cell
+    ADSPartition(const FloatVec &centroids) :
+        centroids_(centroids)
+    {
+    }
+
+
+    // Sets part[c] to the part (0..partCnt-1) of cell c
+    void rcb(PWP_UINT32 partCnt, UINT32Vec &part) const
+    {
+        const size_t cellCnt = centroids_.size() / 3;
+        UINT32Vec cells(cellCnt);
+        for (size_t c = 0; c < cellCnt; ++c) {
+            cells[c] = PWP_UINT32(c);
+        }
+        part.resize(cellCnt);
+        bisect(cells.data(), cells.data() + cellCnt, 0,
+            (0 == partCnt) ? 1 : partCnt, part);
+    }
+
+
+private:
+
+    // Assigns the cells in [beg, end) to the partCnt parts starting at
+    // firstPart
+    void bisect(PWP_UINT32 *beg, PWP_UINT32 *end, PWP_UINT32 firstPart,
+        PWP_UINT32 partCnt, UINT32Vec &part) const
+    {
+        while (partCnt > 1) {
+            const int axis = longestAxis(beg, end);
+            const PWP_UINT32 loParts = partCnt / 2;
+            PWP_UINT32 *mid = beg + size_t(PWP_UINT64(end - beg) * loParts /
+                partCnt);
+            const FloatVec &xyz = centroids_;
+            std::nth_element(beg, mid, end,
+                [&](PWP_UINT32 a, PWP_UINT32 b) {
+                    const float ca = xyz[size_t(a) * 3 + axis];
+                    const float cb = xyz[size_t(b) * 3 + axis];
+                    return (ca < cb) || (ca == cb && a < b);
+                });
+            bisect(beg, mid, firstPart, loParts, part);
+            // continue with the upper half
+            beg = mid;
+            firstPart += loParts;
+            partCnt -= loParts;
+        }
+        for (; beg != end; ++beg) {
+            part[*beg] = firstPart;
+        }
+    }
+
+
+    // Axis (0..2) of the longest side of the bounding box of the cells in
+    // [beg, end)
+    int longestAxis(const PWP_UINT32 *beg, const PWP_UINT32 *end) const
+    {
+        if (beg == end) {
+            return 0;
+        }
+        float lo[3];
+        float hi[3];
+        for (int i = 0; i < 3; ++i) {
+            lo[i] = hi[i] = centroids_[size_t(*beg) * 3 + i];
+        }
+        for (const PWP_UINT32 *c = beg + 1; c != end; ++c) {
+            const float *p = &centroids_[size_t(*c) * 3];
+            for (int i = 0; i < 3; ++i) {
+                lo[i] = std::min(lo[i], p[i]);
+                hi[i] = std::max(hi[i], p[i]);
+            }
+        }
+        int axis = 0;
+        for (int i = 1; i < 3; ++i) {
+            if (hi[i] - lo[i] > hi[axis] - lo[axis]) {
+                axis = i;
+            }
+        }
+        return axis;
+    }
+
+
+private:
+
+    // XYZ of each cell
+    const FloatVec &    centroids_;
+};
+
+
+// Gives the distinct values of a list local numbers in increasing order.
+// For example, the REST vertex indices used by a partition's cells. An open
+// addressing hash table finds the distinct values, so only they are sorted.
+class ADSLocalNumbering {
+public:
+
+    typedef std::vector<PWP_UINT32> UINT32Vec;
+
+
+    ADSLocalNumbering() :
+        keys_(),
+        local_(),
+        size_(0)
+    {
+    }
+
+
+    // Sets distinct to the distinct values in vals in increasing order and
+    // replaces each value with its 1-based position in distinct. The values
+    // must not be 0.
+    void number(UINT32Vec &vals, UINT32Vec &distinct)
+    {
+        size_t cap = 16;
+        while (cap < vals.size() / 4) {
+            cap <<= 1;
+        }
+        keys_.assign(cap, 0);
+        size_ = 0;
+        distinct.clear();
+        for (size_t i = 0; i < vals.size(); ++i) {
+            if (insert(vals[i])) {
+                distinct.push_back(vals[i]);
+            }
+        }
+        std::sort(distinct.begin(), distinct.end());
+        local_.resize(keys_.size());
+        for (size_t i = 0; i < distinct.size(); ++i) {
+            local_[slot(distinct[i])] = PWP_UINT32(i + 1);
+        }
+        for (size_t i = 0; i < vals.size(); ++i) {
+            vals[i] = local_[slot(vals[i])];
+        }
+    }
+
+
+private:
+
+    // Slot of v or the empty slot where it belongs
+    inline size_t slot(PWP_UINT32 v) const
+    {
+        const size_t mask = keys_.size() - 1;
+        size_t s = size_t((PWP_UINT64(v) * 0x9E3779B97F4A7C15ULL) >> 32) &
+            mask;
+        while (0 != keys_[s] && v != keys_[s]) {
+            s = (s + 1) & mask;
+        }
+        return s;
+    }
+
+
+    // Adds v to the table. Returns false if it is already there.
+    inline bool insert(PWP_UINT32 v)
+    {
+        const size_t s = slot(v);
+        if (v == keys_[s]) {
+            return false;
+        }
+        keys_[s] = v;
+        if (2 * ++size_ > keys_.size()) {
+            // keep the table at most half full
+            UINT32Vec old(2 * keys_.size(), 0);
+            old.swap(keys_);
+            for (size_t i = 0; i < old.size(); ++i) {
+                if (0 != old[i]) {
+                    keys_[slot(old[i])] = old[i];
+                }
+            }
+        }
+        return true;
+    }
+
+
+private:
+
+    // Hash table of the distinct values. 0 marks an empty slot.
+    UINT32Vec   keys_;
+
+    // Local number of the value in each slot of keys_
+    UINT32Vec   local_;
+
+    // Number of values in keys_
+    size_t      size_;
+};
+
+#endif /* _ADSPARTITION_H_ */
+
+/****************************************************************************
+ *
+ * This file is licensed under the Cadence Public License Version 1.0 (the
+ * "License"), a copy of which is found in the included file named "LICENSE",
+ * and is distributed "AS IS." TO THE MAXIMUM EXTENT PERMITTED BY APPLICABLE
+ * LAW, CADENCE DISCLAIMS ALL WARRANTIES AND IN NO EVENT SHALL BE LIABLE TO
+ * ANY PARTY FOR ANY DAMAGES ARISING OUT OF OR RELATING TO USE OF THIS FILE.
+ * Please see the License for the full text of applicable terms.
+ *
+ ****************************************************************************/
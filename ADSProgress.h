@@ -0,0 +1,185 @@
+/****************************************************************************
+ *
+ * (C) 2021 Cadence Design Systems, Inc. All rights reserved worldwide.
+ *
+ * This sample source code is not supported by Cadence Design Systems, Inc.
+ * It is provided freely for demonstration purposes only.
+ * SEE THE WARRANTY DISCLAIMER AT THE BOTTOM OF THIS FILE.
+ *
+ ***************************************************************************/
+/****************************************************************************
+ *
+ * ADSProgress: Throttled progress reporting and abort polling
+ *
+ ***************************************************************************/
+
+#ifndef _ADSPROGRESS_H_
+#define _ADSPROGRESS_H_
+
+#include "apiCAEP.h"
+#include "apiCAEPUtils.h"
+#include "apiPWP.h"
+
+#include <atomic>
+
+
+// Counts the items completed in a progress step and forwards them to
+// caeuProgressIncr() one stride at a time. A step of N items is reported as
+// N / stride increments, so the progress bar still fills up with far fewer
+// calls than items. The stride is N / MaxStepIncrs, but at most MaxStride,
+// so a step makes at most max(MaxStepIncrs, N / MaxStride) calls. The cap
+// keeps cancel responsive on very large meshes, because caeuProgressIncr()
+// is where a user cancel is seen.
+//
+// add() and aborted() may be called from any thread. The other methods make
+// the caeuProgress*() calls and must be called from the exporting thread.
+class ADSProgress {
+public:
+
+    enum {
+        // Number of caeuProgressIncr() calls a step is split into. Steps of
+        // more than MaxStepIncrs * MaxStride items make more calls.
+        MaxStepIncrs = 1000,
+
+        // Max items in one stride. Bounds the time between abort polls.
+        MaxStride = 16384
+    };
+
+
+    ADSProgress(CAEP_RTITEM &rti) :
+        rti_(rti),
+        total_(0),
+        stride_(1),
+        stepIncrs_(0),
+        incrs_(0),
+        nextIncr_(1),
+        done_(0),
+        aborted_(false)
+    {
+    }
+
+
+    // Starts a step of total items. Returns false if aborted.
+    bool beginStep(PWP_UINT64 total)
+    {
+        total_ = total;
+        const PWP_UINT64 stride = total / MaxStepIncrs;
+        if (stride < 1) {
+            stride_ = 1;
+        }
+        else if (stride > MaxStride) {
+            stride_ = MaxStride;
+        }
+        else {
+            stride_ = PWP_UINT32(stride);
+        }
+        stepIncrs_ = PWP_UINT32((total + stride_ - 1) / stride_);
+        incrs_ = 0;
+        nextIncr_ = stride_;
+        done_.store(0, std::memory_order_relaxed);
+        if (!caeuProgressBeginStep(&rti_, stepIncrs_)) {
+            aborted_ = true;
+        }
+        return !aborted();
+    }
+
+
+    // Counts items as done without reporting them. Returns false if aborted.
+    inline bool add(PWP_UINT32 items)
+    {
+        done_.fetch_add(items, std::memory_order_relaxed);
+        return !aborted();
+    }
+
+
+    // Counts items as done and reports any completed strides. Returns false
+    // if aborted.
+    inline bool incr(PWP_UINT32 items = 1)
+    {
+        const PWP_UINT64 done = items +
+            done_.fetch_add(items, std::memory_order_relaxed);
+        return (done < nextIncr_) ? !aborted_ : update();
+    }
+
+
+    // Reports the completed strides counted so far. The last partial stride
+    // is reported once all the step's items are done. Returns false if
+    // aborted.
+    bool update()
+    {
+        const PWP_UINT64 done = done_.load(std::memory_order_relaxed);
+        const PWP_UINT32 want = (done >= total_) ? stepIncrs_ :
+            PWP_UINT32(done / stride_);
+        while (incrs_ < want && !aborted_) {
+            if (!caeuProgressIncr(&rti_)) {
+                aborted_ = true;
+            }
+            ++incrs_;
+        }
+        nextIncr_ = PWP_UINT64(incrs_ + 1) * stride_;
+        return !aborted();
+    }
+
+
+    // Reports any remaining items and ends the step. Returns false if
+    // aborted.
+    bool endStep()
+    {
+        update();
+        if (!caeuProgressEndStep(&rti_)) {
+            aborted_ = true;
+        }
+        return !aborted();
+    }
+
+
+    inline bool aborted() const
+    {
+        return aborted_ || CAEPU_RT_IS_ABORTED(&rti_);
+    }
+
+
+private:
+
+    // Not copyable
+    ADSProgress(const ADSProgress &);
+    ADSProgress &operator=(const ADSProgress &);
+
+
+private:
+
+    CAEP_RTITEM &           rti_;
+
+    // Number of items in the current step
+    PWP_UINT64              total_;
+
+    // Number of items per caeuProgressIncr() call
+    PWP_UINT32              stride_;
+
+    // Number of caeuProgressIncr() calls for the whole step and the number
+    // made so far
+    PWP_UINT32              stepIncrs_;
+    PWP_UINT32              incrs_;
+
+    // Item count at which incr() makes the next caeuProgressIncr() call
+    PWP_UINT64              nextIncr_;
+
+    // Number of items done in the current step
+    std::atomic<PWP_UINT64> done_;
+
+    // Set once the export is aborted
+    std::atomic<bool>       aborted_;
+};
+
+#endif /* _ADSPROGRESS_H_ */
+
+/****************************************************************************
+ *
+ * This file is licensed under the Cadence Public License Version 1.0 (the
+ * "License"), a copy of which is found in the included file named "LICENSE",
+ * and is distributed "AS IS." TO THE MAXIMUM EXTENT PERMITTED BY APPLICABLE
+ * LAW, CADENCE DISCLAIMS ALL WARRANTIES AND IN NO EVENT SHALL BE LIABLE TO
+ * ANY PARTY FOR ANY DAMAGES ARISING OUT OF OR RELATING TO USE OF THIS FILE.
+ * Please see the License for the full text of applicable terms.
+ *
+ ****************************************************************************/
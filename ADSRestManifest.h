@@ -0,0 +1,253 @@
+/****************************************************************************
+ *
+ * (C) 2021 Cadence Design Systems, Inc. All rights reserved worldwide.
+ *
+ * This sample source code is not supported by Cadence Design Systems, Inc.
+ * It is provided freely for demonstration purposes only.
+ * SEE THE WARRANTY DISCLAIMER AT THE BOTTOM OF THIS FILE.
+ *
+ ***************************************************************************/
+/****************************************************************************
+ *
+ * ADSRestManifest: Section fingerprints of an exported REST file
+ *
+ ***************************************************************************/
+
+#ifndef _ADSRESTMANIFEST_H_
+#define _ADSRESTMANIFEST_H_
+
+#include "apiPWP.h"
+
+#include <cstdio>
+#include <cstring>
+
+
+// Fast, non-cryptographic 64 bit hash. Data is mixed in 8 byte words.
+class ADSHash64 {
+public:
+
+    ADSHash64(PWP_UINT64 seed = 0) :
+        h_(seed ^ 0x9E3779B97F4A7C15ull)
+    {
+    }
+
+
+    inline void add(const void *data, size_t n)
+    {
+        const unsigned char *p = (const unsigned char*)data;
+        PWP_UINT64 w;
+        for (; n >= sizeof(w); n -= sizeof(w), p += sizeof(w)) {
+            memcpy(&w, p, sizeof(w));
+            mix(w);
+        }
+        if (0 != n) {
+            w = 0;
+            memcpy(&w, p, n);
+            mix(w ^ (PWP_UINT64(n) << 56));
+        }
+    }
+
+
+    template<typename T>
+    inline void add(const T &val)
+    {
+        add(&val, sizeof(val));
+    }
+
+
+    inline PWP_UINT64 value() const
+    {
+        PWP_UINT64 h = h_;
+        h ^= h >> 33;
+        h *= 0xFF51AFD7ED558CCDull;
+        h ^= h >> 33;
+        return h;
+    }
+
+
+private:
+
+    inline void mix(PWP_UINT64 w)
+    {
+        h_ = (h_ ^ (w * 0xC2B2AE3D27D4EB4Full)) * 0x9E3779B97F4A7C15ull;
+        h_ ^= h_ >> 29;
+    }
+
+
+private:
+
+    PWP_UINT64  h_;
+};
+
+
+// Records where each reusable section is in a REST file and a fingerprint
+// of the grid data it was made from. An incremental export compares its
+// fingerprints with the manifest of the previous export and copies the
+// sections that match from the previous REST file.
+class ADSRestManifest {
+public:
+
+    enum Section {
+        Vertices,
+        Connectivity,
+        BcFaces,
+        NumSections
+    };
+
+    struct Entry {
+        // Fingerprint of the section inputs
+        PWP_UINT64  hash;
+
+        // Hash of a sparse sample of the section's grid data
+        PWP_UINT64  sample;
+
+        // Position and size of the section in the REST file
+        PWP_UINT64  offset;
+        PWP_UINT64  bytes;
+
+        // Set if the other members are known
+        bool        valid;
+    };
+
+
+    ADSRestManifest() :
+        fileSize_(0)
+    {
+        clear();
+    }
+
+
+    void clear()
+    {
+        fileSize_ = 0;
+        memset(entries_, 0, sizeof(entries_));
+    }
+
+
+    inline void set(Section s, PWP_UINT64 hash, PWP_UINT64 sample,
+        PWP_UINT64 offset, PWP_UINT64 bytes)
+    {
+        entries_[s].hash = hash;
+        entries_[s].sample = sample;
+        entries_[s].offset = offset;
+        entries_[s].bytes = bytes;
+        entries_[s].valid = true;
+    }
+
+
+    inline const Entry &get(Section s) const
+    {
+        return entries_[s];
+    }
+
+
+    // Size of the whole REST file
+    inline void setFileSize(PWP_UINT64 size)
+    {
+        fileSize_ = size;
+    }
+
+
+    inline PWP_UINT64 getFileSize() const
+    {
+        return fileSize_;
+    }
+
+
+    // Reads a manifest written by write(). Returns false if the file does
+    // not exist or is not a valid manifest.
+    bool read(const char *fileName)
+    {
+        clear();
+        FILE *fp = fopen(fileName, "r");
+        if (0 == fp) {
+            return false;
+        }
+        unsigned version = 0;
+        unsigned long long size = 0;
+        bool ret = (2 == fscanf(fp, "ADS REST manifest %u size %llu",
+            &version, &size)) && (Version == version);
+        fileSize_ = size;
+        for (int s = 0; ret && s < NumSections; ++s) {
+            char sec[32];
+            unsigned long long hash;
+            unsigned long long sample;
+            unsigned long long offset;
+            unsigned long long bytes;
+            ret = (5 == fscanf(fp, "%31s %llx %llx %llu %llu", sec, &hash,
+                &sample, &offset, &bytes)) && (0 == strcmp(sec, name(s))) &&
+                (offset + bytes <= size);
+            set(Section(s), hash, sample, offset, bytes);
+        }
+        fclose(fp);
+        if (!ret) {
+            clear();
+        }
+        return ret;
+    }
+
+
+    // Writes the manifest. Returns false if a section is not set or the file
+    // could not be written.
+    bool write(const char *fileName) const
+    {
+        for (int s = 0; s < NumSections; ++s) {
+            if (!entries_[s].valid) {
+                return false;
+            }
+        }
+        FILE *fp = fopen(fileName, "w");
+        if (0 == fp) {
+            return false;
+        }
+        fprintf(fp, "ADS REST manifest %u\nsize %llu\n", Version,
+            (unsigned long long)fileSize_);
+        for (int s = 0; s < NumSections; ++s) {
+            fprintf(fp, "%s %016llx %016llx %llu %llu\n", name(s),
+                (unsigned long long)entries_[s].hash,
+                (unsigned long long)entries_[s].sample,
+                (unsigned long long)entries_[s].offset,
+                (unsigned long long)entries_[s].bytes);
+        }
+        bool ret = (0 == ferror(fp));
+        ret = (0 == fclose(fp)) && ret;
+        return ret;
+    }
+
+
+    // Section name used in the manifest file
+    static const char *name(int s)
+    {
+        static const char * const names[NumSections] = {
+            "vertices", "connectivity", "bcFaces"
+        };
+        return names[s];
+    }
+
+
+private:
+
+    enum {
+        // Manifest file format version
+        Version = 3
+    };
+
+
+private:
+
+    PWP_UINT64  fileSize_;
+    Entry       entries_[NumSections];
+};
+
+#endif /* _ADSRESTMANIFEST_H_ */
+
+/****************************************************************************
+ *
+ * This file is licensed under the Cadence Public License Version 1.0 (the
+ * "License"), a copy of which is found in the included file named "LICENSE",
+ * and is distributed "AS IS." TO THE MAXIMUM EXTENT PERMITTED BY APPLICABLE
+ * LAW, CADENCE DISCLAIMS ALL WARRANTIES AND IN NO EVENT SHALL BE LIABLE TO
+ * ANY PARTY FOR ANY DAMAGES ARISING OUT OF OR RELATING TO USE OF THIS FILE.
+ * Please see the License for the full text of applicable terms.
+ *
+ ****************************************************************************/
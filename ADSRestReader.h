@@ -0,0 +1,286 @@
+/****************************************************************************
+ *
+ * (C) 2021 Cadence Design Systems, Inc. All rights reserved worldwide.
+ *
+ * This sample source code is not supported by Cadence Design Systems, Inc.
+ * It is provided freely for demonstration purposes only.
+ * SEE THE WARRANTY DISCLAIMER AT THE BOTTOM OF THIS FILE.
+ *
+ ***************************************************************************/
+/****************************************************************************
+ *
+ * ADSRestReader: Memory-mapped binary REST file reader
+ *
+ ***************************************************************************/
+
+#ifndef _ADSRESTREADER_H_
+#define _ADSRESTREADER_H_
+
+#include "apiPWP.h"
+
+#include "ADSMappedFile.h"
+
+#include <cstring>
+#include <string>
+
+
+// Maps a binary REST file and locates its sections. The layout is:
+//   title: 80 chars
+//   header: 4 records of 15 integers
+//   vertices: NNL records of XYZ + dependent variable values
+//   connectivity: NEL records of 8 vertex indices
+//   boundary faces: NBCL records of cellID, face and CD tid
+//
+// The file does not record the integer width or the vertex precision, so
+// the caller gives them to open(). Any part of the file can then be read
+// from any thread.
+class ADSRestReader {
+public:
+
+    enum {
+        TitleSize = 80,
+
+        // Number of header records and values in each
+        HeaderRecords = 4,
+        HeaderValues = 15,
+
+        // Number of values in a connectivity and boundary face record
+        ElemValues = 8,
+        BcValues = 3
+    };
+
+
+    ADSRestReader() :
+        file_(),
+        indexSize_(sizeof(PWP_UINT32)),
+        realSize_(sizeof(float)),
+        vertValues_(0),
+        vertices_(0),
+        elems_(0),
+        bcFaces_(0),
+        error_()
+    {
+        memset(header_, 0, sizeof(header_));
+    }
+
+
+    // Maps fileName and checks that its size matches the section sizes
+    // given by the header. indexSize is the size of each integer (4 or 8)
+    // and realSize is the size of each vertex value (4 or 8). Returns false
+    // and sets error() on failure.
+    bool open(const char *fileName, size_t indexSize, size_t realSize)
+    {
+        close();
+        indexSize_ = indexSize;
+        realSize_ = realSize;
+        if (!file_.openRead(fileName)) {
+            return fail("Could not map the REST file");
+        }
+        const PWP_UINT64 headerSize = TitleSize +
+            PWP_UINT64(HeaderRecords) * HeaderValues * indexSize;
+        if (file_.size() < headerSize) {
+            return fail("The REST file is too small for its header");
+        }
+        const char *p = file_.data() + TitleSize;
+        for (int r = 0; r < HeaderRecords; ++r) {
+            for (int i = 0; i < HeaderValues; ++i) {
+                header_[r][i] = readIndex(p);
+                p += indexSize;
+            }
+        }
+
+        // XYZ + NDVAR values and PSND if NDVAR is not 1
+        const PWP_UINT64 ndvar = getNDVAR();
+        if (ndvar >= 15) {
+            return fail("NDVAR in the REST header is too large");
+        }
+        vertValues_ = 3 + size_t(ndvar) + (1 == ndvar ? 0 : 1);
+        const PWP_UINT64 vertBytes = getNNL() * vertValues_ * realSize;
+        const PWP_UINT64 elemBytes = getNEL() * ElemValues * indexSize;
+        const PWP_UINT64 bcBytes = getNBCL() * BcValues * indexSize;
+        if (getNNL() > file_.size() || getNEL() > file_.size() ||
+                getNBCL() > file_.size() || file_.size() != headerSize +
+                vertBytes + elemBytes + bcBytes) {
+            return fail("The REST file size does not match its header");
+        }
+        vertices_ = file_.data() + headerSize;
+        elems_ = vertices_ + vertBytes;
+        bcFaces_ = elems_ + elemBytes;
+        return true;
+    }
+
+
+    void close()
+    {
+        file_.close();
+        vertices_ = elems_ = bcFaces_ = 0;
+        vertValues_ = 0;
+        memset(header_, 0, sizeof(header_));
+    }
+
+
+    inline const std::string &error() const
+    {
+        return error_;
+    }
+
+
+    inline PWP_UINT64 fileSize() const
+    {
+        return file_.size();
+    }
+
+
+    // The title without its trailing spaces
+    std::string getTitle() const
+    {
+        std::string ret(file_.data(), TitleSize);
+        ret.erase(ret.find_last_not_of(' ') + 1);
+        return ret;
+    }
+
+
+    // Value i of header record r
+    inline PWP_UINT64 getHeader(int r, int i) const
+    {
+        return header_[r][i];
+    }
+
+
+    inline PWP_UINT64 getNSECTIONS() const
+    {
+        return header_[0][0];
+    }
+
+
+    inline PWP_UINT64 getNDVAR() const
+    {
+        return header_[0][2];
+    }
+
+
+    inline PWP_UINT64 getNBK() const
+    {
+        return header_[0][6];
+    }
+
+
+    inline PWP_UINT64 getNNL() const
+    {
+        return header_[2][0];
+    }
+
+
+    inline PWP_UINT64 getNEL() const
+    {
+        return header_[2][1];
+    }
+
+
+    inline PWP_UINT64 getNBCL() const
+    {
+        return header_[2][2];
+    }
+
+
+    inline PWP_UINT64 getNCDUT() const
+    {
+        return header_[2][4];
+    }
+
+
+    // Number of values in each vertex record
+    inline size_t getVertexValueCount() const
+    {
+        return vertValues_;
+    }
+
+
+    // Value j of vertex record v
+    inline double vertexValue(PWP_UINT64 v, size_t j) const
+    {
+        const char *p = vertices_ + (v * vertValues_ + j) * realSize_;
+        if (sizeof(float) == realSize_) {
+            float f;
+            memcpy(&f, p, sizeof(f));
+            return f;
+        }
+        double d;
+        memcpy(&d, p, sizeof(d));
+        return d;
+    }
+
+
+    // Value j of connectivity record e
+    inline PWP_UINT64 elemValue(PWP_UINT64 e, size_t j) const
+    {
+        return readIndex(elems_ + (e * ElemValues + j) * indexSize_);
+    }
+
+
+    // Value j of boundary face record f
+    inline PWP_UINT64 bcValue(PWP_UINT64 f, size_t j) const
+    {
+        return readIndex(bcFaces_ + (f * BcValues + j) * indexSize_);
+    }
+
+
+private:
+
+    inline PWP_UINT64 readIndex(const char *p) const
+    {
+        if (sizeof(PWP_UINT32) == indexSize_) {
+            PWP_UINT32 v;
+            memcpy(&v, p, sizeof(v));
+            return v;
+        }
+        PWP_UINT64 v;
+        memcpy(&v, p, sizeof(v));
+        return v;
+    }
+
+
+    bool fail(const char *msg)
+    {
+        error_ = msg;
+        vertices_ = elems_ = bcFaces_ = 0;
+        return false;
+    }
+
+
+private:
+
+    // The mapped REST file
+    ADSMappedFile   file_;
+
+    // Size in bytes of each integer and each vertex value
+    size_t          indexSize_;
+    size_t          realSize_;
+
+    // The header values
+    PWP_UINT64      header_[HeaderRecords][HeaderValues];
+
+    // Number of values in each vertex record
+    size_t          vertValues_;
+
+    // Start of each section
+    const char *    vertices_;
+    const char *    elems_;
+    const char *    bcFaces_;
+
+    // Reason open() failed
+    std::string     error_;
+};
+
+#endif /* _ADSRESTREADER_H_ */
+
+/****************************************************************************
+ *
+ * This file is licensed under the Cadence Public License Version 1.0 (the
+ * "License"), a copy of which is found in the included file named "LICENSE",
+ * and is distributed "AS IS." TO THE MAXIMUM EXTENT PERMITTED BY APPLICABLE
+ * LAW, CADENCE DISCLAIMS ALL WARRANTIES AND IN NO EVENT SHALL BE LIABLE TO
+ * ANY PARTY FOR ANY DAMAGES ARISING OUT OF OR RELATING TO USE OF THIS FILE.
+ * Please see the License for the full text of applicable terms.
+ *
+ ****************************************************************************/
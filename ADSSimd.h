@@ -0,0 +1,404 @@
+/****************************************************************************
+ *
+ * (C) 2021 Cadence Design Systems, Inc. All rights reserved worldwide.
+ *
+ * This sample source code is not supported by Cadence Design Systems, Inc.
+ * It is provided freely for demonstration purposes only.
+ * SEE THE WARRANTY DISCLAIMER AT THE BOTTOM OF THIS FILE.
+ *
+ ***************************************************************************/
+/****************************************************************************
+ *
+ * ADSSimd: SSE2/AVX2 record kernels for the connectivity and vertex
+ *          sections
+ *
+ ***************************************************************************/
+
+#ifndef _ADSSIMD_H_
+#define _ADSSIMD_H_
+
+#include "apiGridModel.h"
+#include "apiPWP.h"
+
+#include <cstring>
+
+// SSE2 is part of every x86-64 CPU. AVX2 is detected at run time.
+#if defined(__x86_64__) || defined(_M_X64)
+#   define ADS_SIMD_X86
+#   include <immintrin.h>
+#   if defined(_MSC_VER)
+#       include <intrin.h>
+#       define ADS_TARGET_AVX2
+#   else
+#       define ADS_TARGET_AVX2 __attribute__((target("avx2")))
+#   endif
+#endif
+
+
+// The kernels work on the arrays of a batch of fetched elements or vertices
+// (see ADSFetch.h):
+//
+//   adsRebaseIndices() converts the model vertex indices of elements with
+//   the same vertex count to 1-based REST vertex indices and pads them to
+//   PWGM_ELEMDATA_VERT_SIZE values by repeating the last one.
+//
+//   adsVertexRecords() writes the binary REST record of each vertex: its XYZ
+//   followed by the constant dependent variable and PSND values.
+//
+// Each has a scalar, an SSE2 and an AVX2 version. The best one the CPU
+// supports is picked on first use. All give identical results.
+
+
+// Instruction sets the kernels can use
+enum ADSSimdLevel {
+    ADSSimdScalar,
+    ADSSimdSSE2,
+    ADSSimdAVX2
+};
+
+
+// The best instruction set supported by the CPU and the OS
+static inline ADSSimdLevel
+adsDetectSimd()
+{
+#if defined(ADS_SIMD_X86)
+#   if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] >= 7) {
+        __cpuid(info, 1);
+        // the OS must save the AVX registers (OSXSAVE and XCR0 bits 1, 2)
+        const bool avx = (0 != (info[2] & (1 << 27))) &&
+            (0 != (info[2] & (1 << 28))) && (6 == (_xgetbv(0) & 6));
+        __cpuidex(info, 7, 0);
+        if (avx && 0 != (info[1] & (1 << 5))) {
+            return ADSSimdAVX2;
+        }
+    }
+#   else
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return ADSSimdAVX2;
+    }
+#   endif
+    return ADSSimdSSE2;
+#else
+    return ADSSimdScalar;
+#endif
+}
+
+
+static inline ADSSimdLevel
+adsSimdLevel()
+{
+    static const ADSSimdLevel level = adsDetectSimd();
+    return level;
+}
+
+
+static inline const char *
+adsSimdName(ADSSimdLevel level)
+{
+    switch (level) {
+    case ADSSimdSSE2: return "SSE2";
+    case ADSSimdAVX2: return "AVX2";
+    default: break;
+    }
+    return "scalar";
+}
+
+
+// Converts the indices of n elements of vertCnt (1..8) vertices each. index
+// holds vertCnt values per element and PWGM_ELEMDATA_VERT_SIZE values must
+// be readable from the start of each element. map[i] is the REST position of
+// model vertex i. Indices not in map (all of them if mapSize is 0) keep
+// their position. The record of element i is written to dst at record
+// pos[i].
+typedef void (*ADSRebaseFunc)(const PWP_UINT32 *index, PWP_UINT32 vertCnt,
+    const PWP_UINT32 *pos, size_t n, const PWP_UINT32 *map, size_t mapSize,
+    PWP_UINT32 *dst);
+
+// Writes the binary records of the n vertices at x, y and z to dst. rec is a
+// record of count values whose values after XYZ are copied to every record.
+// Returns a pointer just past the last record.
+typedef char *(*ADSNarrowFunc)(const PWP_REAL *x, const PWP_REAL *y,
+    const PWP_REAL *z, size_t n, const float *rec, size_t count, char *dst);
+
+
+static void
+adsRebaseIndicesScalar(const PWP_UINT32 *index, PWP_UINT32 vertCnt,
+    const PWP_UINT32 *pos, size_t n, const PWP_UINT32 *map, size_t mapSize,
+    PWP_UINT32 *dst)
+{
+    for (size_t e = 0; e < n; ++e, index += vertCnt) {
+        PWP_UINT32 *rec = dst + size_t(pos[e]) * PWGM_ELEMDATA_VERT_SIZE;
+        PWP_UINT32 j;
+        for (j = 0; j < vertCnt; ++j) {
+            const PWP_UINT32 ndx = index[j];
+            rec[j] = ((ndx < mapSize) ? map[ndx] : ndx) + 1;
+        }
+        for (; j < PWGM_ELEMDATA_VERT_SIZE; ++j) {
+            rec[j] = rec[vertCnt - 1];
+        }
+    }
+}
+
+
+static char *
+adsNarrowVerticesScalar(const PWP_REAL *x, const PWP_REAL *y,
+    const PWP_REAL *z, size_t n, const float *rec, size_t count, char *dst)
+{
+    const size_t tailSize = (count - 3) * sizeof(float);
+    for (size_t i = 0; i < n; ++i) {
+        const float xyz[3] = { float(x[i]), float(y[i]), float(z[i]) };
+        memcpy(dst, xyz, sizeof(xyz));
+        memcpy(dst + sizeof(xyz), rec + 3, tailSize);
+        dst += sizeof(xyz) + tailSize;
+    }
+    return dst;
+}
+
+
+#if defined(ADS_SIMD_X86)
+
+// Replaces the 4 lanes of v that used does not select with last and adds 1
+// to every lane
+static inline __m128i
+adsPadIncr(__m128i v, __m128i used, __m128i last)
+{
+    v = _mm_or_si128(_mm_and_si128(used, v), _mm_andnot_si128(used, last));
+    return _mm_add_epi32(v, _mm_set1_epi32(1));
+}
+
+
+static void
+adsRebaseIndicesSSE2(const PWP_UINT32 *index, PWP_UINT32 vertCnt,
+    const PWP_UINT32 *pos, size_t n, const PWP_UINT32 *map, size_t mapSize,
+    PWP_UINT32 *dst)
+{
+    // the lanes that hold the element's indices
+    const __m128i cnt = _mm_set1_epi32(int(vertCnt));
+    const __m128i usedLo = _mm_cmplt_epi32(_mm_setr_epi32(0, 1, 2, 3), cnt);
+    const __m128i usedHi = _mm_cmplt_epi32(_mm_setr_epi32(4, 5, 6, 7), cnt);
+    PWP_UINT32 tmp[PWGM_ELEMDATA_VERT_SIZE];
+    for (size_t e = 0; e < n; ++e, index += vertCnt) {
+        const PWP_UINT32 *ndx = index;
+        if (0 != mapSize) {
+            // SSE2 has no gather
+            memcpy(tmp, index, sizeof(tmp));
+            for (PWP_UINT32 j = 0; j < vertCnt; ++j) {
+                if (tmp[j] < mapSize) {
+                    tmp[j] = map[tmp[j]];
+                }
+            }
+            ndx = tmp;
+        }
+        const __m128i last = _mm_set1_epi32(int(ndx[vertCnt - 1]));
+        const __m128i lo = _mm_loadu_si128((const __m128i*)ndx);
+        const __m128i hi = _mm_loadu_si128((const __m128i*)(ndx + 4));
+        PWP_UINT32 *rec = dst + size_t(pos[e]) * PWGM_ELEMDATA_VERT_SIZE;
+        _mm_storeu_si128((__m128i*)rec, adsPadIncr(lo, usedLo, last));
+        _mm_storeu_si128((__m128i*)(rec + 4), adsPadIncr(hi, usedHi, last));
+    }
+}
+
+
+ADS_TARGET_AVX2 static void
+adsRebaseIndicesAVX2(const PWP_UINT32 *index, PWP_UINT32 vertCnt,
+    const PWP_UINT32 *pos, size_t n, const PWP_UINT32 *map, size_t mapSize,
+    PWP_UINT32 *dst)
+{
+    // Lane permutation that repeats lane vertCnt - 1 in lanes vertCnt and up
+    alignas(32) static const int Pad[PWGM_ELEMDATA_VERT_SIZE + 1][8] = {
+        { 0, 0, 0, 0, 0, 0, 0, 0 },
+        { 0, 0, 0, 0, 0, 0, 0, 0 },
+        { 0, 1, 1, 1, 1, 1, 1, 1 },
+        { 0, 1, 2, 2, 2, 2, 2, 2 },
+        { 0, 1, 2, 3, 3, 3, 3, 3 },
+        { 0, 1, 2, 3, 4, 4, 4, 4 },
+        { 0, 1, 2, 3, 4, 5, 5, 5 },
+        { 0, 1, 2, 3, 4, 5, 6, 6 },
+        { 0, 1, 2, 3, 4, 5, 6, 7 }
+    };
+    if (mapSize > 0x7FFFFFFF) {
+        // the gather offsets are signed
+        adsRebaseIndicesScalar(index, vertCnt, pos, n, map, mapSize, dst);
+        return;
+    }
+    const __m256i one = _mm256_set1_epi32(1);
+    const __m256i pad = _mm256_load_si256((const __m256i*)Pad[vertCnt]);
+    // the lanes that hold the element's indices
+    const __m256i used = _mm256_cmpgt_epi32(_mm256_set1_epi32(int(vertCnt)),
+        _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+    // unsigned compares are done as signed compares of the values with
+    // their sign bits flipped
+    const __m256i bias = _mm256_set1_epi32(int(0x80000000u));
+    const __m256i size = _mm256_set1_epi32(int(PWP_UINT32(mapSize) ^
+        0x80000000u));
+    for (size_t e = 0; e < n; ++e, index += vertCnt) {
+        __m256i ndx = _mm256_loadu_si256((const __m256i*)index);
+        if (0 != mapSize) {
+            // only the element's lanes that are in map are loaded
+            const __m256i inMap = _mm256_cmpgt_epi32(size,
+                _mm256_xor_si256(ndx, bias));
+            ndx = _mm256_mask_i32gather_epi32(ndx, (const int*)map, ndx,
+                _mm256_and_si256(used, inMap), 4);
+        }
+        ndx = _mm256_permutevar8x32_epi32(_mm256_add_epi32(ndx, one), pad);
+        _mm256_storeu_si256(
+            (__m256i*)(dst + size_t(pos[e]) * PWGM_ELEMDATA_VERT_SIZE), ndx);
+    }
+}
+
+
+static char *
+adsNarrowVerticesSSE2(const PWP_REAL *x, const PWP_REAL *y,
+    const PWP_REAL *z, size_t n, const float *rec, size_t count, char *dst)
+{
+    if (count < 4) {
+        return adsNarrowVerticesScalar(x, y, z, n, rec, count, dst);
+    }
+    const size_t recSize = count * sizeof(float);
+    const size_t tailSize = recSize - 4 * sizeof(float);
+    const __m128 rec3 = _mm_set1_ps(rec[3]);
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        // two vertices: x0 x1, y0 y1 and z0 z1
+        const __m128 vx = _mm_cvtpd_ps(_mm_loadu_pd(x + i));
+        const __m128 vy = _mm_cvtpd_ps(_mm_loadu_pd(y + i));
+        const __m128 vz = _mm_cvtpd_ps(_mm_loadu_pd(z + i));
+        const __m128 xy = _mm_unpacklo_ps(vx, vy);
+        const __m128 zr = _mm_unpacklo_ps(vz, rec3);
+        // x0 y0 z0 rec[3] and x1 y1 z1 rec[3]
+        _mm_storeu_ps((float*)dst, _mm_movelh_ps(xy, zr));
+        memcpy(dst + 4 * sizeof(float), rec + 4, tailSize);
+        dst += recSize;
+        _mm_storeu_ps((float*)dst, _mm_movehl_ps(zr, xy));
+        memcpy(dst + 4 * sizeof(float), rec + 4, tailSize);
+        dst += recSize;
+    }
+    return adsNarrowVerticesScalar(x + i, y + i, z + i, n - i, rec, count,
+        dst);
+}
+
+
+ADS_TARGET_AVX2 static char *
+adsNarrowVerticesAVX2(const PWP_REAL *x, const PWP_REAL *y,
+    const PWP_REAL *z, size_t n, const float *rec, size_t count, char *dst)
+{
+    if (count < 4) {
+        return adsNarrowVerticesScalar(x, y, z, n, rec, count, dst);
+    }
+    const size_t recSize = count * sizeof(float);
+    const size_t tailSize = recSize - 4 * sizeof(float);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        // four vertices: x0..x3, y0..y3, z0..z3 and rec[3] transposed into
+        // the first 4 values of each record
+        __m128 r0 = _mm256_cvtpd_ps(_mm256_loadu_pd(x + i));
+        __m128 r1 = _mm256_cvtpd_ps(_mm256_loadu_pd(y + i));
+        __m128 r2 = _mm256_cvtpd_ps(_mm256_loadu_pd(z + i));
+        __m128 r3 = _mm_set1_ps(rec[3]);
+        _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+        const __m128 head[4] = { r0, r1, r2, r3 };
+        for (int k = 0; k < 4; ++k) {
+            _mm_storeu_ps((float*)dst, head[k]);
+            memcpy(dst + 4 * sizeof(float), rec + 4, tailSize);
+            dst += recSize;
+        }
+    }
+    return adsNarrowVerticesScalar(x + i, y + i, z + i, n - i, rec, count,
+        dst);
+}
+
+#endif /* ADS_SIMD_X86 */
+
+
+static inline ADSRebaseFunc
+adsRebaseFunc(ADSSimdLevel level)
+{
+#if defined(ADS_SIMD_X86)
+    switch (level) {
+    case ADSSimdAVX2: return adsRebaseIndicesAVX2;
+    case ADSSimdSSE2: return adsRebaseIndicesSSE2;
+    default: break;
+    }
+#else
+    (void)level;
+#endif
+    return adsRebaseIndicesScalar;
+}
+
+
+static inline ADSNarrowFunc
+adsNarrowFunc(ADSSimdLevel level)
+{
+#if defined(ADS_SIMD_X86)
+    switch (level) {
+    case ADSSimdAVX2: return adsNarrowVerticesAVX2;
+    case ADSSimdSSE2: return adsNarrowVerticesSSE2;
+    default: break;
+    }
+#else
+    (void)level;
+#endif
+    return adsNarrowVerticesScalar;
+}
+
+
+static inline void
+adsRebaseIndices(const PWP_UINT32 *index, PWP_UINT32 vertCnt,
+    const PWP_UINT32 *pos, size_t n, const PWP_UINT32 *map, size_t mapSize,
+    PWP_UINT32 *dst)
+{
+    static const ADSRebaseFunc rebase = adsRebaseFunc(adsSimdLevel());
+    if (0 != vertCnt && vertCnt <= PWGM_ELEMDATA_VERT_SIZE) {
+        rebase(index, vertCnt, pos, n, map, mapSize, dst);
+        return;
+    }
+    // not a valid element - its records get the invalid index 0
+    for (size_t e = 0; e < n; ++e) {
+        memset(dst + size_t(pos[e]) * PWGM_ELEMDATA_VERT_SIZE, 0,
+            PWGM_ELEMDATA_VERT_SIZE * sizeof(PWP_UINT32));
+    }
+}
+
+
+// Single precision vertex records
+static inline char *
+adsVertexRecords(const PWP_REAL *x, const PWP_REAL *y, const PWP_REAL *z,
+    size_t n, const float *rec, size_t count, char *dst)
+{
+    static const ADSNarrowFunc narrow = adsNarrowFunc(adsSimdLevel());
+    return narrow(x, y, z, n, rec, count, dst);
+}
+
+
+// Double precision vertex records. No conversion is needed, so the compiler
+// does as well as any kernel.
+static inline char *
+adsVertexRecords(const PWP_REAL *x, const PWP_REAL *y, const PWP_REAL *z,
+    size_t n, const double *rec, size_t count, char *dst)
+{
+    const size_t tailSize = (count - 3) * sizeof(double);
+    for (size_t i = 0; i < n; ++i) {
+        const double xyz[3] = { x[i], y[i], z[i] };
+        memcpy(dst, xyz, sizeof(xyz));
+        memcpy(dst + sizeof(xyz), rec + 3, tailSize);
+        dst += sizeof(xyz) + tailSize;
+    }
+    return dst;
+}
+
+#endif /* _ADSSIMD_H_ */
+
+/****************************************************************************
+ *
+ * This file is licensed under the Cadence Public License Version 1.0 (the
+ * "License"), a copy of which is found in the included file named "LICENSE",
+ * and is distributed "AS IS." TO THE MAXIMUM EXTENT PERMITTED BY APPLICABLE
+ * LAW, CADENCE DISCLAIMS ALL WARRANTIES AND IN NO EVENT SHALL BE LIABLE TO
+ * ANY PARTY FOR ANY DAMAGES ARISING OUT OF OR RELATING TO USE OF THIS FILE.
+ * Please see the License for the full text of applicable terms.
+ *
+ ****************************************************************************/
@@ -0,0 +1,289 @@
+/****************************************************************************
+ *
+ * (C) 2021 Cadence Design Systems, Inc. All rights reserved worldwide.
+ *
+ * This sample source code is not supported by Cadence Design Systems, Inc.
+ * It is provided freely for demonstration purposes only.
+ * SEE THE WARRANTY DISCLAIMER AT THE BOTTOM OF THIS FILE.
+ *
+ ***************************************************************************/
+/****************************************************************************
+ *
+ * ADSStageStats: Per-stage export instrumentation
+ *
+ ***************************************************************************/
+
+#ifndef _ADSSTAGESTATS_H_
+#define _ADSSTAGESTATS_H_
+
+#include "apiPWP.h"
+#include "pwpPlatform.h"
+
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+#include <string>
+
+#if defined(_WIN32)
+#   if !defined(NOMINMAX)
+#       define NOMINMAX
+#   endif
+#   include <windows.h>
+#else
+#   include <time.h>
+#endif
+
+
+// Records the wall time, CPU time, bytes written, records emitted and grid
+// model calls of each export stage. When disabled, begin() and end() only
+// test a flag.
+//
+// Different stages may run at the same time on different threads. The CPU
+// time of a stage on the export thread is for the whole process, so it
+// includes the stage's worker threads and any overlapping stages. The
+// BCVAL and BCTYPE stages run on their own threads and get the CPU time of
+// that thread, or 0 where there is no thread CPU clock.
+class ADSStageStats {
+public:
+
+    enum Stage {
+        Title,
+        Header,
+        VertexOrder,
+        CellOrder,
+        Partition,
+        Vertices,
+        Connectivity,
+        BcFaces,
+        PartitionFiles,
+        Validate,
+        BcVal,
+        BcType,
+        NumStages
+    };
+
+
+    struct Data {
+        // Wall and CPU time in seconds
+        double      wallSec;
+        double      cpuSec;
+
+        // Bytes written to the stage's file
+        PWP_UINT64  bytes;
+
+        // Records (vertices, elements, faces, lines) emitted
+        PWP_UINT64  records;
+
+        // Grid model API calls made by the stage
+        PWP_UINT64  gridCalls;
+
+        // True if the stage ran to its end() call
+        bool        done;
+    };
+
+
+    ADSStageStats() :
+        enabled_(false)
+    {
+        clear();
+    }
+
+
+    void clear()
+    {
+        for (int i = 0; i < NumStages; ++i) {
+            data_[i].wallSec = 0.0;
+            data_[i].cpuSec = 0.0;
+            data_[i].bytes = 0;
+            data_[i].records = 0;
+            data_[i].gridCalls = 0;
+            data_[i].done = false;
+        }
+    }
+
+
+    inline void enable(bool onOff)
+    {
+        enabled_ = onOff;
+    }
+
+
+    inline bool enabled() const
+    {
+        return enabled_;
+    }
+
+
+    // Starts timing stage s. bytes is the file's current byte count.
+    inline void begin(Stage s, PWP_UINT64 bytes = 0)
+    {
+        if (enabled_) {
+            start_[s].wall = Clock::now();
+            start_[s].cpu = cpuSeconds(s);
+            start_[s].bytes = bytes;
+        }
+    }
+
+
+    // Stops timing stage s. bytes is the file's current byte count.
+    inline void end(Stage s, PWP_UINT64 bytes, PWP_UINT64 records,
+        PWP_UINT64 gridCalls)
+    {
+        if (enabled_) {
+            const Start &st = start_[s];
+            const std::chrono::duration<double> wall = Clock::now() - st.wall;
+            Data &d = data_[s];
+            d.wallSec += wall.count();
+            d.cpuSec += cpuSeconds(s) - st.cpu;
+            d.bytes += (bytes > st.bytes) ? bytes - st.bytes : 0;
+            d.records += records;
+            d.gridCalls += gridCalls;
+            d.done = true;
+        }
+    }
+
+
+    // Adds counts to stage s while it is running
+    inline void addCounts(Stage s, PWP_UINT64 records, PWP_UINT64 gridCalls)
+    {
+        if (enabled_) {
+            data_[s].records += records;
+            data_[s].gridCalls += gridCalls;
+        }
+    }
+
+
+    inline const Data &get(Stage s) const
+    {
+        return data_[s];
+    }
+
+
+    static const char *name(Stage s)
+    {
+        static const char *names[NumStages] = {
+            "title", "header", "vertexOrder", "cellOrder", "partition",
+            "vertices", "connectivity", "bcFaces", "partFiles", "validate",
+            "bcval", "bctype"
+        };
+        return names[s];
+    }
+
+
+    // Returns a one line summary of stage s
+    std::string format(Stage s) const
+    {
+        const Data &d = data_[s];
+        const double mbps = (d.wallSec > 0.0) ?
+            double(d.bytes) / (1024.0 * 1024.0) / d.wallSec : 0.0;
+        char buf[256];
+        sprintf(buf, "%-12s %9.4fs wall %9.4fs cpu %12llu bytes "
+            "%9.1f MB/s %10llu records %10llu grid calls", name(s), d.wallSec,
+            d.cpuSec, (unsigned long long)d.bytes, mbps,
+            (unsigned long long)d.records, (unsigned long long)d.gridCalls);
+        return buf;
+    }
+
+
+    // Writes the completed stages to fileName as a JSON object. Returns
+    // false if the file could not be written.
+    bool writeJson(const char *fileName) const
+    {
+        FILE *fp = pwpFileOpen(fileName, pwpWrite | pwpAscii);
+        if (0 == fp) {
+            return false;
+        }
+        std::string json("{\n  \"stages\": [");
+        const char *sep = "\n";
+        char buf[512];
+        for (int i = 0; i < NumStages; ++i) {
+            const Data &d = data_[i];
+            if (!d.done) {
+                continue;
+            }
+            sprintf(buf, "%s    { \"name\": \"%s\", \"wallSec\": %.6f, "
+                "\"cpuSec\": %.6f, \"bytes\": %llu, \"records\": %llu, "
+                "\"gridCalls\": %llu }", sep, name(Stage(i)), d.wallSec,
+                d.cpuSec, (unsigned long long)d.bytes,
+                (unsigned long long)d.records,
+                (unsigned long long)d.gridCalls);
+            json += buf;
+            sep = ",\n";
+        }
+        json += "\n  ]\n}\n";
+        const bool ret =
+            (json.size() == pwpFileWrite(json.data(), 1, json.size(), fp));
+        return (0 == pwpFileClose(fp)) && ret;
+    }
+
+
+private:
+
+    typedef std::chrono::steady_clock Clock;
+
+    struct Start {
+        Clock::time_point   wall;
+        double              cpu;
+        PWP_UINT64          bytes;
+    };
+
+
+    // CPU time in seconds of the process, or of the calling thread for the
+    // stages that run on their own thread
+    static double cpuSeconds(Stage s)
+    {
+        if (BcVal != s && BcType != s) {
+            return double(std::clock()) / CLOCKS_PER_SEC;
+        }
+#if defined(_WIN32)
+        FILETIME created;
+        FILETIME exited;
+        FILETIME kernel;
+        FILETIME user;
+        if (GetThreadTimes(GetCurrentThread(), &created, &exited, &kernel,
+                &user)) {
+            return 1.0e-7 * (ticks(kernel) + ticks(user));
+        }
+#elif defined(CLOCK_THREAD_CPUTIME_ID)
+        timespec ts;
+        if (0 == clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts)) {
+            return double(ts.tv_sec) + 1.0e-9 * double(ts.tv_nsec);
+        }
+#endif
+        return 0.0;
+    }
+
+#if defined(_WIN32)
+    // Number of 100 ns units in t
+    static double ticks(const FILETIME &t)
+    {
+        return double(t.dwHighDateTime) * 4294967296.0 +
+            double(t.dwLowDateTime);
+    }
+#endif
+
+
+private:
+
+    // If false, begin() and end() do nothing
+    bool                enabled_;
+
+    // Start of each stage's current begin() / end() pair
+    Start               start_[NumStages];
+
+    // Totals for each stage
+    Data                data_[NumStages];
+};
+
+#endif /* _ADSSTAGESTATS_H_ */
+
+/****************************************************************************
+ *
+ * This file is licensed under the Cadence Public License Version 1.0 (the
+ * "License"), a copy of which is found in the included file named "LICENSE",
+ * and is distributed "AS IS." TO THE MAXIMUM EXTENT PERMITTED BY APPLICABLE
+ * LAW, CADENCE DISCLAIMS ALL WARRANTIES AND IN NO EVENT SHALL BE LIABLE TO
+ * ANY PARTY FOR ANY DAMAGES ARISING OUT OF OR RELATING TO USE OF THIS FILE.
+ * Please see the License for the full text of applicable terms.
+ *
+ ****************************************************************************/
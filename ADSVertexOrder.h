@@ -0,0 +1,269 @@
+/****************************************************************************
+ *
+ * (C) 2021 Cadence Design Systems, Inc. All rights reserved worldwide.
+ *
+ * This sample source code is not supported by Cadence Design Systems, Inc.
+ * It is provided freely for demonstration purposes only.
+ * SEE THE WARRANTY DISCLAIMER AT THE BOTTOM OF THIS FILE.
+ *
+ ***************************************************************************/
+/****************************************************************************
+ *
+ * ADSVertexOrder: Bandwidth reducing vertex renumbering
+ *
+ ***************************************************************************/
+
+#ifndef _ADSVERTEXORDER_H_
+#define _ADSVERTEXORDER_H_
+
+#include "apiPWP.h"
+
+#include <algorithm>
+#include <vector>
+
+
+// Computes a reverse Cuthill-McKee (RCM) order of the vertices of an element
+// mesh. Two vertices are neighbors if they share an element. Numbering the
+// vertices in this order keeps the indices of each element close together,
+// which reduces the bandwidth of the solver's matrices and improves its
+// cache use.
+//
+// The elements are given as fixed size records of Stride vertex indices.
+// Only the first elemVertCnts[e] indices of element e are used. The order
+// only depends on the elements, so the same mesh always gets the same order.
+class ADSVertexOrder {
+public:
+
+    typedef std::vector<PWP_UINT32> UINT32Vec;
+    typedef std::vector<PWP_UINT8>  UINT8Vec;
+
+
+    ADSVertexOrder(PWP_UINT32 vertCnt, PWP_UINT32 stride,
+            const UINT32Vec &elemVerts, const UINT8Vec &elemVertCnts) :
+        vertCnt_(vertCnt),
+        stride_(stride),
+        elemVerts_(elemVerts),
+        elemVertCnts_(elemVertCnts),
+        adjStart_(),
+        adj_(),
+        marks_(vertCnt, 0),
+        stamp_(0)
+    {
+    }
+
+
+    // Sets newToOld[i] to the vertex numbered i by the RCM order. Returns
+    // false if an element references a vertex index >= vertCnt.
+    bool rcm(UINT32Vec &newToOld)
+    {
+        newToOld.clear();
+        if (!buildAdjacency()) {
+            return false;
+        }
+        newToOld.reserve(vertCnt_);
+        UINT8Vec placed(vertCnt_, 0);
+        UINT32Vec queue;
+        for (PWP_UINT32 v = 0; v < vertCnt_; ++v) {
+            if (!placed[v]) {
+                // v starts a new connected component
+                cuthillMcKee(peripheralVertex(v, queue), placed, newToOld);
+            }
+        }
+        std::reverse(newToOld.begin(), newToOld.end());
+        return true;
+    }
+
+
+private:
+
+    // Number of neighbors of vertex v
+    inline PWP_UINT32 degree(PWP_UINT32 v) const
+    {
+        return PWP_UINT32(adjStart_[v + 1] - adjStart_[v]);
+    }
+
+
+    // Builds the neighbor list of every vertex. The elements using each
+    // vertex are found first and their vertices are merged.
+    bool buildAdjacency()
+    {
+        const PWP_UINT32 elemCnt = PWP_UINT32(elemVertCnts_.size());
+        UINT32Vec vertElemStart(size_t(vertCnt_) + 1, 0);
+        for (PWP_UINT32 e = 0; e < elemCnt; ++e) {
+            const PWP_UINT32 *verts = &elemVerts_[size_t(e) * stride_];
+            for (PWP_UINT32 i = 0; i < elemVertCnts_[e]; ++i) {
+                if (verts[i] >= vertCnt_) {
+                    return false;
+                }
+                ++vertElemStart[verts[i] + 1];
+            }
+        }
+        for (PWP_UINT32 v = 0; v < vertCnt_; ++v) {
+            vertElemStart[v + 1] += vertElemStart[v];
+        }
+        UINT32Vec vertElems(vertElemStart[vertCnt_]);
+        {
+            UINT32Vec next(vertElemStart.begin(), vertElemStart.end() - 1);
+            for (PWP_UINT32 e = 0; e < elemCnt; ++e) {
+                const PWP_UINT32 *verts = &elemVerts_[size_t(e) * stride_];
+                for (PWP_UINT32 i = 0; i < elemVertCnts_[e]; ++i) {
+                    vertElems[next[verts[i]]++] = e;
+                }
+            }
+        }
+        adjStart_.resize(size_t(vertCnt_) + 1);
+        adj_.clear();
+        for (PWP_UINT32 v = 0; v < vertCnt_; ++v) {
+            adjStart_[v] = adj_.size();
+            newStamp();
+            marks_[v] = stamp_;
+            for (PWP_UINT32 i = vertElemStart[v]; i < vertElemStart[v + 1];
+                    ++i) {
+                const PWP_UINT32 e = vertElems[i];
+                const PWP_UINT32 *verts = &elemVerts_[size_t(e) * stride_];
+                for (PWP_UINT32 j = 0; j < elemVertCnts_[e]; ++j) {
+                    if (stamp_ != marks_[verts[j]]) {
+                        marks_[verts[j]] = stamp_;
+                        adj_.push_back(verts[j]);
+                    }
+                }
+            }
+        }
+        adjStart_[vertCnt_] = adj_.size();
+        return true;
+    }
+
+
+    // Appends the neighbors of v not marked with the current stamp to nbrs
+    // and marks them
+    inline void addNeighbors(PWP_UINT32 v, UINT32Vec &nbrs)
+    {
+        for (size_t i = adjStart_[v]; i < adjStart_[v + 1]; ++i) {
+            const PWP_UINT32 n = adj_[i];
+            if (stamp_ != marks_[n]) {
+                marks_[n] = stamp_;
+                nbrs.push_back(n);
+            }
+        }
+    }
+
+
+    // Starts a new search. Every vertex becomes unmarked.
+    void newStamp()
+    {
+        if (0 == ++stamp_) {
+            std::fill(marks_.begin(), marks_.end(), 0);
+            stamp_ = 1;
+        }
+    }
+
+
+    // Finds a vertex far from the others in v's component (George and Liu).
+    // A breadth first search from the current start is repeated from the
+    // lowest degree vertex of its last level while the number of levels
+    // grows.
+    PWP_UINT32 peripheralVertex(PWP_UINT32 v, UINT32Vec &queue)
+    {
+        const int MaxSearches = 4;
+        PWP_UINT32 start = v;
+        PWP_UINT32 depth = 0;
+        for (int n = 0; n < MaxSearches; ++n) {
+            newStamp();
+            queue.clear();
+            queue.push_back(start);
+            marks_[start] = stamp_;
+            PWP_UINT32 levels = 0;
+            size_t levelBeg = 0;
+            size_t levelEnd = 1;
+            size_t lastBeg = 0;
+            while (levelBeg < levelEnd) {
+                lastBeg = levelBeg;
+                for (size_t i = levelBeg; i < levelEnd; ++i) {
+                    addNeighbors(queue[i], queue);
+                }
+                levelBeg = levelEnd;
+                levelEnd = queue.size();
+                ++levels;
+            }
+            if (0 != n && levels <= depth) {
+                break;
+            }
+            depth = levels;
+            PWP_UINT32 best = queue[lastBeg];
+            for (size_t i = lastBeg + 1; i < queue.size(); ++i) {
+                if (degree(queue[i]) < degree(best) ||
+                        (degree(queue[i]) == degree(best) &&
+                            queue[i] < best)) {
+                    best = queue[i];
+                }
+            }
+            start = best;
+        }
+        return start;
+    }
+
+
+    // Appends start's component to order in Cuthill-McKee order. The
+    // unplaced neighbors of each vertex are added by increasing degree.
+    void cuthillMcKee(PWP_UINT32 start, UINT8Vec &placed, UINT32Vec &order)
+    {
+        newStamp();
+        UINT32Vec nbrs;
+        size_t head = order.size();
+        order.push_back(start);
+        placed[start] = 1;
+        marks_[start] = stamp_;
+        auto byDegree = [&](PWP_UINT32 a, PWP_UINT32 b) {
+            return degree(a) < degree(b) || (degree(a) == degree(b) && a < b);
+        };
+        while (head < order.size()) {
+            nbrs.clear();
+            addNeighbors(order[head++], nbrs);
+            std::sort(nbrs.begin(), nbrs.end(), byDegree);
+            for (size_t i = 0; i < nbrs.size(); ++i) {
+                placed[nbrs[i]] = 1;
+                order.push_back(nbrs[i]);
+            }
+        }
+    }
+
+
+private:
+
+    // Not copyable
+    ADSVertexOrder(const ADSVertexOrder &);
+    ADSVertexOrder &operator=(const ADSVertexOrder &);
+
+
+private:
+
+    // Number of vertices
+    PWP_UINT32          vertCnt_;
+
+    // Element vertex records
+    PWP_UINT32          stride_;
+    const UINT32Vec &   elemVerts_;
+    const UINT8Vec &    elemVertCnts_;
+
+    // Neighbors of each vertex. Vertex v's neighbors are
+    // adj_[adjStart_[v] .. adjStart_[v + 1]).
+    std::vector<size_t> adjStart_;
+    UINT32Vec           adj_;
+
+    // Search marks. A vertex is marked if its mark equals stamp_.
+    UINT32Vec           marks_;
+    PWP_UINT32          stamp_;
+};
+
+#endif /* _ADSVERTEXORDER_H_ */
+
+/****************************************************************************
+ *
+ * This file is licensed under the Cadence Public License Version 1.0 (the
+ * "License"), a copy of which is found in the included file named "LICENSE",
+ * and is distributed "AS IS." TO THE MAXIMUM EXTENT PERMITTED BY APPLICABLE
+ * LAW, CADENCE DISCLAIMS ALL WARRANTIES AND IN NO EVENT SHALL BE LIABLE TO
+ * ANY PARTY FOR ANY DAMAGES ARISING OUT OF OR RELATING TO USE OF THIS FILE.
+ * Please see the License for the full text of applicable terms.
+ *
+ ****************************************************************************/
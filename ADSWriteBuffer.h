@@ -0,0 +1,446 @@
+/****************************************************************************
+ *
+ * (C) 2021 Cadence Design Systems, Inc. All rights reserved worldwide.
+ *
+ * This sample source code is not supported by Cadence Design Systems, Inc.
+ * It is provided freely for demonstration purposes only.
+ * SEE THE WARRANTY DISCLAIMER AT THE BOTTOM OF THIS FILE.
+ *
+ ***************************************************************************/
+/****************************************************************************
+ *
+ * ADSWriteBuffer: Large staging buffer for REST file output
+ *
+ ***************************************************************************/
+
+#ifndef _ADSWRITEBUFFER_H_
+#define _ADSWRITEBUFFER_H_
+
+#include "apiPWP.h"
+#include "pwpPlatform.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+#   include <unistd.h>
+#endif
+
+
+// Receives the write buffer's chunks in place of a file. For example, a
+// compressor.
+class ADSWriteSink {
+public:
+
+    virtual ~ADSWriteSink()
+    {
+    }
+
+    // Consumes n bytes at data. Returns false on failure.
+    virtual bool write(const void *data, size_t n) = 0;
+};
+
+
+// Records are appended to a large in-memory buffer that is handed to the
+// file in multi-megabyte chunks. This replaces one fwrite() call per vertex,
+// element and boundary face with one call per chunk.
+//
+// The buffer can also target a fixed size block of memory (for example, part
+// of a memory-mapped file) or an ADSWriteSink instead of a file.
+//
+// With enableAsync(), full chunks are handed to an I/O thread. The caller
+// fills the next chunk while the I/O thread writes the previous one.
+class ADSWriteBuffer {
+public:
+
+    enum {
+        // Default staging buffer size in bytes
+        DefaultSize = 16 * 1024 * 1024,
+
+        // Max number of chunks waiting for the I/O thread. The caller
+        // blocks when the queue is full.
+        MaxPending = 2
+    };
+
+
+    ADSWriteBuffer(FILE *fp, size_t capacity = DefaultSize) :
+        fp_(fp),
+        sink_(0),
+        dest_(0),
+        destSize_(0),
+        buf_(0 == capacity ? size_t(DefaultSize) : capacity),
+        used_(0),
+        bytes_(0),
+        ok_(0 != fp),
+        ioOk_(true),
+        async_(false),
+        stop_(false),
+        busy_(false)
+    {
+    }
+
+    ADSWriteBuffer(ADSWriteSink *sink, size_t capacity = DefaultSize) :
+        fp_(0),
+        sink_(sink),
+        dest_(0),
+        destSize_(0),
+        buf_(0 == capacity ? size_t(DefaultSize) : capacity),
+        used_(0),
+        bytes_(0),
+        ok_(0 != sink),
+        ioOk_(true),
+        async_(false),
+        stop_(false),
+        busy_(false)
+    {
+    }
+
+    ADSWriteBuffer(char *dest, size_t destSize, size_t capacity = 65536) :
+        fp_(0),
+        sink_(0),
+        dest_(dest),
+        destSize_(destSize),
+        buf_(0 == capacity ? size_t(DefaultSize) : capacity),
+        used_(0),
+        bytes_(0),
+        ok_(0 != dest),
+        ioOk_(true),
+        async_(false),
+        stop_(false),
+        busy_(false)
+    {
+    }
+
+    ~ADSWriteBuffer()
+    {
+        close();
+    }
+
+
+    // Starts the I/O thread. Only used for file and sink output.
+    void enableAsync()
+    {
+        if (!async_ && 0 == dest_) {
+            async_ = true;
+            stop_ = false;
+            ioThread_ = std::thread(&ADSWriteBuffer::ioLoop, this);
+        }
+    }
+
+
+    // Returns a pointer to at least n bytes of free buffer space. The caller
+    // fills some or all of it and then calls commit() with the number of
+    // bytes actually used.
+    inline char *reserve(size_t n)
+    {
+        if (buf_.size() - used_ < n) {
+            flush();
+            if (buf_.size() < n) {
+                buf_.resize(n);
+            }
+        }
+        return &buf_[used_];
+    }
+
+
+    inline void commit(size_t n)
+    {
+        used_ += n;
+    }
+
+
+    inline void write(const void *data, size_t n)
+    {
+        if (n > buf_.size() - used_) {
+            flush();
+            if (n >= buf_.size()) {
+                // too big to stage - send it straight to the file
+                waitIdle();
+                writeBlock(data, n);
+                return;
+            }
+        }
+        memcpy(&buf_[used_], data, n);
+        used_ += n;
+    }
+
+
+    template<typename T>
+    inline void writeRecord(const T *vals, size_t count)
+    {
+        write(vals, sizeof(T) * count);
+    }
+
+
+    bool flush()
+    {
+        if (0 == used_) {
+            // nothing staged
+        }
+        else if (async_) {
+            submit();
+        }
+        else {
+            writeBlock(&buf_[0], used_);
+        }
+        used_ = 0;
+        return ok();
+    }
+
+
+    // Appends n bytes of src starting at offset. Only supported when writing
+    // to a file. On Linux, copy_file_range() lets the kernel (or the file
+    // server) copy the data without passing it through user space.
+    bool copyFrom(FILE *src, PWP_UINT64 offset, PWP_UINT64 n)
+    {
+        flush();
+        waitIdle();
+        if (!ok() || 0 == fp_ || 0 == src || 0 != fflush(fp_)) {
+            ok_ = false;
+            return false;
+        }
+        bytes_ += n;
+#if defined(__linux__)
+        loff_t off = loff_t(offset);
+        while (0 != n) {
+            const size_t MaxCopy = size_t(1) << 30;
+            const ssize_t cnt = copy_file_range(fileno(src), &off,
+                fileno(fp_), 0, (n < MaxCopy ? size_t(n) : MaxCopy), 0);
+            if (cnt <= 0) {
+                // not supported here - copy the rest below
+                break;
+            }
+            n -= PWP_UINT64(cnt);
+        }
+        offset = PWP_UINT64(off);
+        // resync the stream with the descriptor
+        if (0 != fseeko(fp_, 0, SEEK_END)) {
+            ok_ = false;
+        }
+#endif
+        if (ok_ && 0 != n && !seek(src, offset)) {
+            ok_ = false;
+        }
+        while (ok_ && 0 != n) {
+            const size_t cnt = fread(&buf_[0], 1,
+                (n < buf_.size() ? size_t(n) : buf_.size()), src);
+            if (0 == cnt || cnt != pwpFileWrite(&buf_[0], 1, cnt, fp_)) {
+                ok_ = false;
+            }
+            n -= cnt;
+        }
+        return ok_;
+    }
+
+
+    // Flushes any staged data and detaches from the file. Returns false if
+    // any write to the file failed.
+    bool close()
+    {
+        flush();
+        if (async_) {
+            {
+                std::lock_guard<std::mutex> lock(mtx_);
+                stop_ = true;
+            }
+            cv_.notify_all();
+            ioThread_.join();
+            async_ = false;
+        }
+        fp_ = 0;
+        sink_ = 0;
+        dest_ = 0;
+        return ok();
+    }
+
+
+    inline bool ok() const
+    {
+        return ok_ && ioOk_;
+    }
+
+
+    // Total number of bytes passed (or queued) to the file or memory block so
+    // far
+    inline PWP_UINT64 bytesWritten() const
+    {
+        return bytes_;
+    }
+
+
+    // Total number of bytes written or staged so far
+    inline PWP_UINT64 bytesAppended() const
+    {
+        return bytes_ + used_;
+    }
+
+
+private:
+
+    static bool seek(FILE *fp, PWP_UINT64 offset)
+    {
+#if defined(_WIN32)
+        return 0 == _fseeki64(fp, __int64(offset), SEEK_SET);
+#else
+        return 0 == fseeko(fp, off_t(offset), SEEK_SET);
+#endif
+    }
+
+
+    // Writes n bytes to the file or sink
+    bool writeOut(const void *data, size_t n)
+    {
+        if (0 != sink_) {
+            return sink_->write(data, n);
+        }
+        return (0 != fp_) && (n == pwpFileWrite(data, 1, n, fp_));
+    }
+
+
+    void writeBlock(const void *data, size_t n)
+    {
+        if (!ok()) {
+            // already failed
+        }
+        else if (0 != dest_) {
+            if (n > destSize_ - size_t(bytes_)) {
+                // would overrun the memory block
+                ok_ = false;
+            }
+            else {
+                memcpy(dest_ + bytes_, data, n);
+            }
+        }
+        else if (!writeOut(data, n)) {
+            ok_ = false;
+        }
+        bytes_ += n;
+    }
+
+
+    // Queues the staged chunk for the I/O thread and continues in a free
+    // chunk
+    void submit()
+    {
+        const size_t capacity = buf_.size();
+        std::vector<char> next;
+        {
+            std::unique_lock<std::mutex> lock(mtx_);
+            cv_.wait(lock, [&]() {
+                return pending_.size() < size_t(MaxPending);
+            });
+            if (!free_.empty()) {
+                next.swap(free_.back());
+                free_.pop_back();
+            }
+            pending_.push_back(Chunk());
+            pending_.back().data.swap(buf_);
+            pending_.back().size = used_;
+        }
+        cv_.notify_all();
+        bytes_ += used_;
+        next.resize(capacity);
+        buf_.swap(next);
+    }
+
+
+    // Waits until the I/O thread has written every queued chunk
+    void waitIdle()
+    {
+        if (async_) {
+            std::unique_lock<std::mutex> lock(mtx_);
+            cv_.wait(lock, [&]() { return pending_.empty() && !busy_; });
+        }
+    }
+
+
+    // I/O thread loop
+    void ioLoop()
+    {
+        for (;;) {
+            Chunk chunk;
+            {
+                std::unique_lock<std::mutex> lock(mtx_);
+                cv_.wait(lock, [&]() { return stop_ || !pending_.empty(); });
+                if (pending_.empty()) {
+                    return;
+                }
+                chunk.data.swap(pending_.front().data);
+                chunk.size = pending_.front().size;
+                pending_.pop_front();
+                busy_ = true;
+            }
+            if (ioOk_ && !writeOut(&chunk.data[0], chunk.size)) {
+                // the caller sees this through ok()
+                ioOk_ = false;
+            }
+            {
+                std::lock_guard<std::mutex> lock(mtx_);
+                free_.push_back(std::vector<char>());
+                free_.back().swap(chunk.data);
+                busy_ = false;
+            }
+            cv_.notify_all();
+        }
+    }
+
+
+private:
+
+    // Destination file
+    FILE *              fp_;
+
+    // Destination sink used instead of fp_
+    ADSWriteSink *      sink_;
+
+    // Destination memory block used instead of fp_
+    char *              dest_;
+    size_t              destSize_;
+
+    // Staging buffer and the number of bytes currently staged in it
+    std::vector<char>   buf_;
+    size_t              used_;
+
+    // Number of bytes written to fp_, sink_ or dest_
+    PWP_UINT64          bytes_;
+
+    // Set to false if a write to fp_, sink_ or dest_ fails
+    bool                ok_;
+
+    // Set to false if a write on the I/O thread fails
+    std::atomic<bool>   ioOk_;
+
+    struct Chunk {
+        std::vector<char>   data;
+        size_t              size;
+    };
+
+    // I/O thread state. mtx_ guards pending_, free_, stop_ and busy_.
+    bool                async_;
+    std::thread         ioThread_;
+    std::mutex          mtx_;
+    std::condition_variable cv_;
+    std::deque<Chunk>   pending_;
+    std::vector<std::vector<char> > free_;
+    bool                stop_;
+    bool                busy_;
+};
+
+#endif /* _ADSWRITEBUFFER_H_ */
+
+/****************************************************************************
+ *
+ * This file is licensed under the Cadence Public License Version 1.0 (the
+ * "License"), a copy of which is found in the included file named "LICENSE",
+ * and is distributed "AS IS." TO THE MAXIMUM EXTENT PERMITTED BY APPLICABLE
+ * LAW, CADENCE DISCLAIMS ALL WARRANTIES AND IN NO EVENT SHALL BE LIABLE TO
+ * ANY PARTY FOR ANY DAMAGES ARISING OUT OF OR RELATING TO USE OF THIS FILE.
+ * Please see the License for the full text of applicable terms.
+ *
+ ****************************************************************************/
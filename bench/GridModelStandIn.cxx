@@ -0,0 +1,933 @@
+/****************************************************************************
+ *
+ * (C) 2021 Cadence Design Systems, Inc. All rights reserved worldwide.
+ *
+ * This sample source code is not supported by Cadence Design Systems, Inc.
+ * It is provided freely for demonstration purposes only.
+ * SEE THE WARRANTY DISCLAIMER AT THE BOTTOM OF THIS FILE.
+ *
+ ***************************************************************************/
+/****************************************************************************
+ *
+ * Grid model stand-in implementation. Meshes are generated on the fly from
+ * closed-form index math, so any size can be exported without storing it.
+ * All queries are read-only and safe to call from multiple threads.
+ *
+ * Also implements the CAEP utility and platform file functions that
+ * runtimeWrite.cxx calls.
+ *
+ ***************************************************************************/
+
+#include "apiCAEPUtils.h"
+#include "apiGridModel.h"
+#include "pwpPlatform.h"
+
+#include "GridModelStandIn.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+
+
+typedef std::map<std::string, std::string> AttrMap;
+
+struct PWGM_HGRIDMODEL_t {
+    SiConfig    cfg;
+
+    // Export attributes set by siSetAttribute()
+    AttrMap     attrs;
+
+    // Number of vertices on the box grid
+    PWP_UINT32  gridVerts;
+
+    // Total number of vertices (includes pyramid apex vertices)
+    PWP_UINT32  verts;
+
+    // Number of hex cells in the box
+    PWP_UINT32  cells;
+
+    // Number of elements each hex cell is split into
+    PWP_UINT32  elemsPerCell;
+
+    // Domain names returned by PwDomCondition()
+    std::vector<std::string> domNames;
+};
+
+
+// Local face vertices of each element type in the grid model's local face
+// order. The ADS exporter's fixFace() maps these face ids to ADS face ids.
+static const int HexFaces[6][4] = {
+    { 0, 3, 2, 1 }, { 4, 5, 6, 7 }, { 0, 1, 5, 4 }, { 1, 2, 6, 5 },
+    { 2, 3, 7, 6 }, { 3, 0, 4, 7 }
+};
+static const int TetFaces[4][3] = {
+    { 0, 2, 1 }, { 0, 1, 3 }, { 1, 2, 3 }, { 2, 0, 3 }
+};
+static const int WedgeFaces[5][4] = {
+    { 0, 1, 2, -1 }, { 3, 5, 4, -1 }, { 0, 1, 4, 3 }, { 1, 2, 5, 4 },
+    { 2, 0, 3, 5 }
+};
+static const int PyramidFaces[5][4] = {
+    { 0, 3, 2, 1 }, { 0, 1, 4, -1 }, { 1, 2, 4, -1 }, { 2, 3, 4, -1 },
+    { 3, 0, 4, -1 }
+};
+
+// Freudenthal split of a cube into 6 tets. Each tet walks from corner 000 to
+// corner 111 stepping along the axes in this order. The split is conforming
+// across neighboring cells.
+static const int TetAxisOrder[6][3] = {
+    { 0, 1, 2 }, { 0, 2, 1 }, { 1, 0, 2 }, { 1, 2, 0 }, { 2, 0, 1 }, { 2, 1, 0 }
+};
+
+// Hex corners used by the 2 prisms of a cell split along the 0-2 diagonal
+static const int PrismCorners[2][6] = {
+    { 0, 1, 2, 4, 5, 6 }, { 0, 2, 3, 4, 6, 7 }
+};
+
+// BC tids assigned round-robin to the domains. 0 (Unspecified) is included
+// to exercise the INVISCID default.
+static const PWP_UINT32 BcTids[] = {
+    8, 2, 3, 13, 14, 4, 7, 19, 20, 11, 0, 17, 18
+};
+
+// Progress state
+typedef std::chrono::steady_clock Clock;
+static SiStepVec        steps;
+static Clock::time_point stepStart;
+static PWP_UINT32       stepIncrs = 0;
+static PWP_UINT32       totalIncrs = 0;
+
+
+static inline PWP_UINT32
+vertId(const PWGM_HGRIDMODEL_t &m, PWP_UINT32 i, PWP_UINT32 j, PWP_UINT32 k)
+{
+    return (k * (m.cfg.nj + 1) + j) * (m.cfg.ni + 1) + i;
+}
+
+
+// Returns the first hex cell of block blk. Blocks are slabs along k.
+static PWP_UINT32
+firstBlockCell(const PWGM_HGRIDMODEL_t &m, PWP_UINT32 blk)
+{
+    const PWP_UINT32 k = PWP_UINT32((PWP_UINT64(blk) * m.cfg.nk +
+        m.cfg.blocks - 1) / m.cfg.blocks);
+    return (k < m.cfg.nk ? k : m.cfg.nk) * m.cfg.ni * m.cfg.nj;
+}
+
+
+static PWGM_ENUM_ELEMTYPE
+cellElemType(const PWGM_HGRIDMODEL_t &m)
+{
+    switch (m.cfg.type) {
+    case SiTet:
+        return PWGM_ELEMTYPE_TET;
+    case SiPrism:
+        return PWGM_ELEMTYPE_WEDGE;
+    case SiPyramid:
+        return PWGM_ELEMTYPE_PYRAMID;
+    default:
+        break;
+    }
+    return PWGM_ELEMTYPE_HEX;
+}
+
+
+static void
+setVertHandles(PWGM_HGRIDMODEL_t &m, PWGM_ELEMDATA &d)
+{
+    for (PWP_UINT32 n = 0; n < d.vertCnt; ++n) {
+        d.vert[n].hP = &m;
+        d.vert[n].id = d.index[n];
+    }
+}
+
+
+// Loads the volume element with model index e
+static void
+getCellElem(PWGM_HGRIDMODEL_t &m, PWP_UINT32 e, PWGM_ELEMDATA &d)
+{
+    const PWP_UINT32 c = e / m.elemsPerCell;
+    const PWP_UINT32 s = e % m.elemsPerCell;
+    const PWP_UINT32 i = c % m.cfg.ni;
+    const PWP_UINT32 j = (c / m.cfg.ni) % m.cfg.nj;
+    const PWP_UINT32 k = c / (m.cfg.ni * m.cfg.nj);
+    const PWP_UINT32 hex[8] = {
+        vertId(m, i, j, k), vertId(m, i + 1, j, k),
+        vertId(m, i + 1, j + 1, k), vertId(m, i, j + 1, k),
+        vertId(m, i, j, k + 1), vertId(m, i + 1, j, k + 1),
+        vertId(m, i + 1, j + 1, k + 1), vertId(m, i, j + 1, k + 1)
+    };
+    d.type = cellElemType(m);
+    switch (m.cfg.type) {
+    case SiHex:
+        d.vertCnt = 8;
+        for (int n = 0; n < 8; ++n) {
+            d.index[n] = hex[n];
+        }
+        break;
+    case SiPrism:
+        d.vertCnt = 6;
+        for (int n = 0; n < 6; ++n) {
+            d.index[n] = hex[PrismCorners[s][n]];
+        }
+        break;
+    case SiPyramid:
+        // base is hex face s, apex is the cell center vertex
+        d.vertCnt = 5;
+        for (int n = 0; n < 4; ++n) {
+            d.index[n] = hex[HexFaces[s][n]];
+        }
+        d.index[4] = m.gridVerts + c;
+        break;
+    case SiTet: {
+        PWP_UINT32 ijk[3] = { 0, 0, 0 };
+        d.vertCnt = 4;
+        d.index[0] = hex[0];
+        for (int n = 0; n < 3; ++n) {
+            ijk[TetAxisOrder[s][n]] = 1;
+            d.index[n + 1] = vertId(m, i + ijk[0], j + ijk[1], k + ijk[2]);
+        }
+        break; }
+    }
+    setVertHandles(m, d);
+}
+
+
+// Loads the vertex indices of local face f of d into fv. Returns the number
+// of face vertices or 0 if f is not a valid face.
+static PWP_UINT32
+getLocalFace(const PWGM_ELEMDATA &d, PWP_UINT32 f, PWP_UINT32 *fv)
+{
+    const int *def = 0;
+    PWP_UINT32 n = 0;
+    switch (d.type) {
+    case PWGM_ELEMTYPE_HEX:
+        if (f < 6) {
+            def = HexFaces[f];
+            n = 4;
+        }
+        break;
+    case PWGM_ELEMTYPE_TET:
+        if (f < 4) {
+            def = TetFaces[f];
+            n = 3;
+        }
+        break;
+    case PWGM_ELEMTYPE_WEDGE:
+        if (f < 5) {
+            def = WedgeFaces[f];
+            n = (f < 2) ? 3 : 4;
+        }
+        break;
+    case PWGM_ELEMTYPE_PYRAMID:
+        if (f < 5) {
+            def = PyramidFaces[f];
+            n = (f < 1) ? 4 : 3;
+        }
+        break;
+    default:
+        break;
+    }
+    for (PWP_UINT32 i = 0; i < n; ++i) {
+        fv[i] = d.index[def[i]];
+    }
+    return n;
+}
+
+
+// Box sides: 0=i-min 1=i-max 2=j-min 3=j-max 4=k-min 5=k-max. Side faces
+// are addressed by (u, v) along the 2 other axes in cyclic order. Side 6 is
+// the baffle, a k plane inside the box.
+static const int BaffleSide = 6;
+
+
+static inline bool
+sideHasTris(const PWGM_HGRIDMODEL_t &m, int side)
+{
+    return (SiTet == m.cfg.type) || (SiPrism == m.cfg.type && side >= 4);
+}
+
+
+// Gets the side of a domain and its strip of u rows [u0, u1). n2 is the
+// number of faces in each row.
+static void
+getDomainStrip(const PWGM_HGRIDMODEL_t &m, PWP_UINT32 dom, int &side,
+    PWP_UINT32 &u0, PWP_UINT32 &u1, PWP_UINT32 &n2)
+{
+    const PWP_UINT32 n[3] = { m.cfg.ni, m.cfg.nj, m.cfg.nk };
+    const PWP_UINT32 strip = dom % m.cfg.domainsPerSide;
+    side = std::min(int(dom / m.cfg.domainsPerSide), BaffleSide);
+    const int a = std::min(side / 2, 2);
+    const PWP_UINT32 n1 = n[(a + 1) % 3];
+    n2 = n[(a + 2) % 3];
+    if (BaffleSide == side) {
+        // the baffle is a single domain
+        u0 = 0;
+        u1 = n1;
+        return;
+    }
+    u0 = PWP_UINT32(PWP_UINT64(strip) * n1 / m.cfg.domainsPerSide);
+    u1 = PWP_UINT32(PWP_UINT64(strip + 1) * n1 / m.cfg.domainsPerSide);
+}
+
+
+static PWP_UINT32
+domainElemCount(const PWGM_HGRIDMODEL_t &m, PWP_UINT32 dom)
+{
+    int side;
+    PWP_UINT32 u0, u1, n2;
+    getDomainStrip(m, dom, side, u0, u1, n2);
+    return (u1 - u0) * n2 * (sideHasTris(m, side) ? 2 : 1);
+}
+
+
+// Loads element e of domain dom and gets the hex cell that owns it
+static void
+getDomainElem(PWGM_HGRIDMODEL_t &m, PWP_UINT32 dom, PWP_UINT32 e,
+    PWGM_ELEMDATA &d, PWP_UINT32 &cell)
+{
+    static const int du[4] = { 0, 1, 1, 0 };
+    static const int dv[4] = { 0, 0, 1, 1 };
+    // quads are split along the (0,0)-(1,1) diagonal to match the volume
+    static const int tris[2][3] = { { 0, 1, 2 }, { 0, 2, 3 } };
+    const PWP_UINT32 n[3] = { m.cfg.ni, m.cfg.nj, m.cfg.nk };
+    int side;
+    PWP_UINT32 u0, u1, n2;
+    getDomainStrip(m, dom, side, u0, u1, n2);
+    const bool hasTris = sideHasTris(m, side);
+    const PWP_UINT32 q = hasTris ? e / 2 : e;
+    const PWP_UINT32 u = u0 + q / n2;
+    const PWP_UINT32 v = q % n2;
+    const int a = std::min(side / 2, 2);
+    const int au = (a + 1) % 3;
+    const int av = (a + 2) % 3;
+    PWP_UINT32 ijk[3];
+    PWP_UINT32 corner[4];
+    const PWP_UINT32 baffleK = m.cfg.nk / 2;
+    ijk[a] = (BaffleSide == side) ? baffleK : (side & 1) ? n[a] : 0;
+    for (int i = 0; i < 4; ++i) {
+        ijk[au] = u + du[i];
+        ijk[av] = v + dv[i];
+        corner[i] = vertId(m, ijk[0], ijk[1], ijk[2]);
+    }
+    // the baffle's owner is the cell below it
+    ijk[a] = (BaffleSide == side) ? baffleK - 1 : (side & 1) ? n[a] - 1 : 0;
+    ijk[au] = u;
+    ijk[av] = v;
+    cell = (ijk[2] * m.cfg.nj + ijk[1]) * m.cfg.ni + ijk[0];
+    if (hasTris) {
+        d.type = PWGM_ELEMTYPE_TRI;
+        d.vertCnt = 3;
+        for (int i = 0; i < 3; ++i) {
+            d.index[i] = corner[tris[e % 2][i]];
+        }
+    }
+    else {
+        d.type = PWGM_ELEMTYPE_QUAD;
+        d.vertCnt = 4;
+        for (int i = 0; i < 4; ++i) {
+            d.index[i] = corner[i];
+        }
+    }
+    setVertHandles(m, d);
+}
+
+
+static bool
+sameVerts(const PWP_UINT32 *a, const PWP_UINT32 *b, PWP_UINT32 n)
+{
+    for (PWP_UINT32 i = 0; i < n; ++i) {
+        bool found = false;
+        for (PWP_UINT32 j = 0; j < n && !found; ++j) {
+            found = (a[i] == b[j]);
+        }
+        if (!found) {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+// Finds the volume element and local face that own a boundary face of hex
+// cell. Returns false if there is no match.
+static bool
+findOwner(PWGM_HGRIDMODEL_t &m, PWP_UINT32 cell, const PWGM_ELEMDATA &face,
+    PWP_UINT32 &elem, PWP_UINT32 &localFace)
+{
+    PWGM_ELEMDATA d;
+    PWP_UINT32 fv[4];
+    PWP_UINT32 n;
+    for (PWP_UINT32 s = 0; s < m.elemsPerCell; ++s) {
+        getCellElem(m, cell * m.elemsPerCell + s, d);
+        for (PWP_UINT32 f = 0; 0 != (n = getLocalFace(d, f, fv)); ++f) {
+            if (n == face.vertCnt && sameVerts(fv, face.index, n)) {
+                elem = cell * m.elemsPerCell + s;
+                localFace = f;
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+
+PWGM_HGRIDMODEL
+siCreateModel(const SiConfig &cfg)
+{
+    PWGM_HGRIDMODEL_t *m = new PWGM_HGRIDMODEL_t;
+    m->cfg = cfg;
+    if (0 == m->cfg.ni) {
+        m->cfg.ni = 1;
+    }
+    if (0 == m->cfg.nj) {
+        m->cfg.nj = 1;
+    }
+    if (0 == m->cfg.nk) {
+        m->cfg.nk = 1;
+    }
+    if (0 == m->cfg.blocks) {
+        m->cfg.blocks = 1;
+    }
+    else if (m->cfg.blocks > m->cfg.nk) {
+        m->cfg.blocks = m->cfg.nk;
+    }
+    if (0 == m->cfg.domainsPerSide) {
+        m->cfg.domainsPerSide = 1;
+    }
+    if (m->cfg.nk < 2) {
+        // there is no interior k plane
+        m->cfg.baffle = false;
+    }
+    m->gridVerts = (m->cfg.ni + 1) * (m->cfg.nj + 1) * (m->cfg.nk + 1);
+    m->cells = m->cfg.ni * m->cfg.nj * m->cfg.nk;
+    m->verts = m->gridVerts + (SiPyramid == m->cfg.type ? m->cells : 0);
+    switch (m->cfg.type) {
+    case SiTet:
+    case SiPyramid:
+        m->elemsPerCell = 6;
+        break;
+    case SiPrism:
+        m->elemsPerCell = 2;
+        break;
+    default:
+        m->elemsPerCell = 1;
+        break;
+    }
+    const PWP_UINT32 domCnt = 6 * m->cfg.domainsPerSide;
+    m->domNames.resize(domCnt);
+    for (PWP_UINT32 d = 0; d < domCnt; ++d) {
+        char name[32];
+        sprintf(name, "bc-%u", (unsigned)d);
+        m->domNames[d] = name;
+    }
+    if (m->cfg.baffle) {
+        m->domNames.push_back("baffle");
+    }
+    m->attrs["Title"] = "Synthetic stand-in model";
+    return m;
+}
+
+
+PWP_VOID
+siDestroyModel(PWGM_HGRIDMODEL model)
+{
+    delete model;
+}
+
+
+PWP_VOID
+siSetAttribute(PWGM_HGRIDMODEL model, const char *name, const char *val)
+{
+    model->attrs[name] = val;
+}
+
+
+const SiStepVec &
+siSteps()
+{
+    return steps;
+}
+
+
+PWP_VOID
+siResetSteps()
+{
+    steps.clear();
+    totalIncrs = 0;
+}
+
+
+/***************************************************************************/
+/* Grid model API                                                          */
+/***************************************************************************/
+
+PWP_UINT32
+PwModBlockCount(PWGM_HGRIDMODEL model)
+{
+    return model->cfg.blocks;
+}
+
+
+PWGM_HBLOCK
+PwModEnumBlocks(PWGM_HGRIDMODEL model, PWP_UINT32 ndx)
+{
+    PWGM_HBLOCK h = { 0, 0 };
+    if (ndx < model->cfg.blocks) {
+        h.hP = model;
+        h.id = ndx;
+    }
+    return h;
+}
+
+
+PWP_UINT32
+PwModDomainCount(PWGM_HGRIDMODEL model)
+{
+    return PWP_UINT32(model->domNames.size());
+}
+
+
+PWGM_HDOMAIN
+PwModEnumDomains(PWGM_HGRIDMODEL model, PWP_UINT32 ndx)
+{
+    PWGM_HDOMAIN h = { 0, 0 };
+    if (ndx < model->domNames.size()) {
+        h.hP = model;
+        h.id = ndx;
+    }
+    return h;
+}
+
+
+PWP_UINT32
+PwModVertexCount(PWGM_HGRIDMODEL model)
+{
+    return model->verts;
+}
+
+
+PWGM_HVERTEX
+PwModEnumVertices(PWGM_HGRIDMODEL model, PWP_UINT32 ndx)
+{
+    PWGM_HVERTEX h = { 0, 0 };
+    if (ndx < model->verts) {
+        h.hP = model;
+        h.id = ndx;
+    }
+    return h;
+}
+
+
+PWP_BOOL
+PwVertDataMod(PWGM_HVERTEX vertex, PWGM_VERTDATA *pVertData)
+{
+    if (!PWGM_HVERTEX_ISVALID(vertex) || 0 == pVertData) {
+        return PWP_FALSE;
+    }
+    const PWGM_HGRIDMODEL_t &m = *vertex.hP;
+    const PWP_UINT32 v = vertex.id;
+    double i, j, k;
+    if (v < m.gridVerts) {
+        i = double(v % (m.cfg.ni + 1));
+        j = double((v / (m.cfg.ni + 1)) % (m.cfg.nj + 1));
+        k = double(v / ((m.cfg.ni + 1) * (m.cfg.nj + 1)));
+    }
+    else {
+        // pyramid apex at the cell center
+        const PWP_UINT32 c = v - m.gridVerts;
+        i = (c % m.cfg.ni) + 0.5;
+        j = ((c / m.cfg.ni) % m.cfg.nj) + 0.5;
+        k = (c / (m.cfg.ni * m.cfg.nj)) + 0.5;
+    }
+    // Slightly sheared box so the coordinates have non-trivial digits
+    pVertData->x = m.cfg.scale * (0.0137 * i + 0.0001 * j);
+    pVertData->y = m.cfg.scale * (-0.021 * j + 0.0005 * k);
+    pVertData->z = m.cfg.scale * (1.25 * k / (m.cfg.nk + 1) + 1.0e-7 * i);
+    pVertData->i = v;
+    return PWP_TRUE;
+}
+
+
+PWP_UINT32
+PwModEnumElementCount(PWGM_HGRIDMODEL model, PWGM_ELEMCOUNTS *pCounts)
+{
+    const PWP_UINT32 n = model->cells * model->elemsPerCell;
+    if (0 != pCounts) {
+        memset(pCounts, 0, sizeof(*pCounts));
+        pCounts->count[cellElemType(*model)] = n;
+    }
+    return n;
+}
+
+
+PWGM_HELEMENT
+PwModEnumElements(PWGM_HGRIDMODEL model, PWP_UINT32 ndx)
+{
+    PWGM_HELEMENT h = { 0, 0, 0, 0 };
+    if (ndx < model->cells * model->elemsPerCell) {
+        h.hP = model;
+        h.id = ndx;
+    }
+    return h;
+}
+
+
+PWP_BOOL
+PwElemDataMod(PWGM_HELEMENT element, PWGM_ELEMDATA *pElemData)
+{
+    if (!PWGM_HELEMENT_ISVALID(element) || 0 == pElemData) {
+        return PWP_FALSE;
+    }
+    if (1 == element.ptype) {
+        PWP_UINT32 cell;
+        getDomainElem(*element.hP, element.pid, element.id, *pElemData, cell);
+    }
+    else {
+        getCellElem(*element.hP, element.id, *pElemData);
+    }
+    return PWP_TRUE;
+}
+
+
+PWP_UINT32
+PwBlkElementCount(PWGM_HBLOCK block, PWGM_ELEMCOUNTS *pCounts)
+{
+    const PWGM_HGRIDMODEL_t &m = *block.hP;
+    const PWP_UINT32 n = (firstBlockCell(m, block.id + 1) -
+        firstBlockCell(m, block.id)) * m.elemsPerCell;
+    if (0 != pCounts) {
+        memset(pCounts, 0, sizeof(*pCounts));
+        pCounts->count[cellElemType(m)] = n;
+    }
+    return n;
+}
+
+
+PWGM_HELEMENT
+PwBlkEnumElements(PWGM_HBLOCK block, PWP_UINT32 ndx)
+{
+    PWGM_HELEMENT h = { 0, 0, 0, 0 };
+    const PWGM_HGRIDMODEL_t &m = *block.hP;
+    const PWP_UINT32 e0 = firstBlockCell(m, block.id) * m.elemsPerCell;
+    const PWP_UINT32 e1 = firstBlockCell(m, block.id + 1) * m.elemsPerCell;
+    if (ndx < e1 - e0) {
+        h.hP = block.hP;
+        h.pid = block.id;
+        h.id = e0 + ndx;
+    }
+    return h;
+}
+
+
+PWP_BOOL
+PwBlkCondition(PWGM_HBLOCK block, PWGM_CONDDATA *pCondData)
+{
+    if (!PWGM_HBLOCK_ISVALID(block) || 0 == pCondData) {
+        return PWP_FALSE;
+    }
+    pCondData->name = "fluid";
+    pCondData->id = block.id + 1;
+    pCondData->type = "Fluid";
+    pCondData->tid = block.hP->cfg.vcTid;
+    return PWP_TRUE;
+}
+
+
+PWP_UINT32
+PwDomElementCount(PWGM_HDOMAIN domain, PWGM_ELEMCOUNTS *pCounts)
+{
+    const PWGM_HGRIDMODEL_t &m = *domain.hP;
+    const PWP_UINT32 n = domainElemCount(m, domain.id);
+    if (0 != pCounts) {
+        int side;
+        PWP_UINT32 u0, u1, n2;
+        getDomainStrip(m, domain.id, side, u0, u1, n2);
+        memset(pCounts, 0, sizeof(*pCounts));
+        pCounts->count[sideHasTris(m, side) ? PWGM_ELEMTYPE_TRI :
+            PWGM_ELEMTYPE_QUAD] = n;
+    }
+    return n;
+}
+
+
+PWGM_HELEMENT
+PwDomEnumElements(PWGM_HDOMAIN domain, PWP_UINT32 ndx)
+{
+    PWGM_HELEMENT h = { 0, 0, 0, 0 };
+    if (ndx < domainElemCount(*domain.hP, domain.id)) {
+        h.hP = domain.hP;
+        h.ptype = 1;
+        h.pid = domain.id;
+        h.id = ndx;
+    }
+    return h;
+}
+
+
+PWP_BOOL
+PwDomCondition(PWGM_HDOMAIN domain, PWGM_CONDDATA *pCondData)
+{
+    if (!PWGM_HDOMAIN_ISVALID(domain) || 0 == pCondData) {
+        return PWP_FALSE;
+    }
+    const PWP_UINT32 d = domain.id;
+    pCondData->name = domain.hP->domNames[d].c_str();
+    pCondData->id = 1 + d / ARRAYSIZE(BcTids);
+    pCondData->type = "bc";
+    pCondData->tid = BcTids[d % ARRAYSIZE(BcTids)];
+    if (0 == d && 0 != domain.hP->cfg.firstBcTid) {
+        pCondData->tid = domain.hP->cfg.firstBcTid;
+    }
+    return PWP_TRUE;
+}
+
+
+// Streams the boundary faces domain by domain in domain element order
+PWP_BOOL
+PwModStreamFaces(PWGM_HGRIDMODEL model, PWGM_ENUM_FACEORDER /*order*/,
+    PWGM_BEGINSTREAMCB beginCB, PWGM_FACESTREAMCB faceCB,
+    PWGM_ENDSTREAMCB endCB, void *userData)
+{
+    const PWP_UINT32 domCnt = PwModDomainCount(model);
+    PWGM_BEGINSTREAM_DATA begin;
+    memset(&begin, 0, sizeof(begin));
+    for (PWP_UINT32 d = 0; d < domCnt; ++d) {
+        begin.totalNumFaces += domainElemCount(*model, d);
+    }
+    begin.numBoundaryFaces = begin.totalNumFaces;
+    begin.numBcFaces = begin.totalNumFaces;
+    begin.userData = userData;
+    bool ok = (0 != beginCB(&begin));
+
+    PWGM_FACESTREAM_DATA face;
+    memset(&face, 0, sizeof(face));
+    face.type = PWGM_FACETYPE_BOUNDARY;
+    face.neighborCellIndex = PWP_UINT32(-1);
+    face.userData = userData;
+    for (PWP_UINT32 d = 0; ok && d < domCnt; ++d) {
+        const PWP_UINT32 cnt = domainElemCount(*model, d);
+        for (PWP_UINT32 e = 0; ok && e < cnt; ++e) {
+            PWP_UINT32 cell;
+            getDomainElem(*model, d, e, face.elemData, cell);
+            if (!findOwner(*model, cell, face.elemData, face.owner.cellIndex,
+                    face.owner.cellFaceIndex)) {
+                fprintf(stderr, "stand-in: no owner for domain %u face %u\n",
+                    (unsigned)d, (unsigned)e);
+                ok = false;
+                break;
+            }
+            face.owner.blockElem = PwModEnumElements(model,
+                face.owner.cellIndex);
+            face.owner.domain = PwModEnumDomains(model, d);
+            face.owner.domainElem = PwDomEnumElements(face.owner.domain, e);
+            face.owner.domainElemIndex = e;
+            ok = (0 != faceCB(&face));
+            ++face.face;
+        }
+    }
+
+    PWGM_ENDSTREAM_DATA end;
+    end.ok = ok;
+    end.userData = userData;
+    return (0 != endCB(&end)) && ok;
+}
+
+
+PWP_BOOL
+PwModGetAttributeString(PWGM_HGRIDMODEL model, const char *name,
+    const char **val)
+{
+    AttrMap::const_iterator it = model->attrs.find(name);
+    if (model->attrs.end() == it) {
+        return PWP_FALSE;
+    }
+    *val = it->second.c_str();
+    return PWP_TRUE;
+}
+
+
+PWP_BOOL
+PwModGetAttributeEnum(PWGM_HGRIDMODEL model, const char *name,
+    const char **val)
+{
+    return PwModGetAttributeString(model, name, val);
+}
+
+
+PWP_BOOL
+PwModGetAttributeUINT32(PWGM_HGRIDMODEL model, const char *name,
+    PWP_UINT32 *val)
+{
+    const char *str;
+    if (!PwModGetAttributeString(model, name, &str)) {
+        return PWP_FALSE;
+    }
+    *val = PWP_UINT32(strtoul(str, 0, 10));
+    return PWP_TRUE;
+}
+
+
+PWP_BOOL
+PwModGetAttributeBOOL(PWGM_HGRIDMODEL model, const char *name, PWP_BOOL *val)
+{
+    const char *str;
+    if (!PwModGetAttributeString(model, name, &str)) {
+        return PWP_FALSE;
+    }
+    *val = (0 == strcmp(str, "true") || 0 == strcmp(str, "1"));
+    return PWP_TRUE;
+}
+
+
+/***************************************************************************/
+/* CAEP utilities                                                          */
+/***************************************************************************/
+
+PWP_BOOL
+caeuProgressInit(CAEP_RTITEM *pRti, PWP_UINT32 cnt)
+{
+    pRti->progTotal = cnt;
+    pRti->progComplete = 0;
+    return !pRti->opAborted;
+}
+
+
+PWP_BOOL
+caeuProgressBeginStep(CAEP_RTITEM *pRti, PWP_UINT32 total)
+{
+    SiStep step;
+    step.total = total;
+    step.incrs = 0;
+    step.seconds = 0.0;
+    steps.push_back(step);
+    stepIncrs = 0;
+    stepStart = Clock::now();
+    return !pRti->opAborted;
+}
+
+
+PWP_BOOL
+caeuProgressIncr(CAEP_RTITEM *pRti)
+{
+    ++stepIncrs;
+    ++totalIncrs;
+    const PWP_UINT32 abortAfter = pRti->model->cfg.abortAfter;
+    if (0 != abortAfter && totalIncrs >= abortAfter) {
+        pRti->opAborted = PWP_TRUE;
+    }
+    return !pRti->opAborted;
+}
+
+
+PWP_BOOL
+caeuProgressEndStep(CAEP_RTITEM *pRti)
+{
+    if (!steps.empty()) {
+        std::chrono::duration<double> dt = Clock::now() - stepStart;
+        steps.back().incrs = stepIncrs;
+        steps.back().seconds = dt.count();
+    }
+    ++pRti->progComplete;
+    return !pRti->opAborted;
+}
+
+
+PWP_VOID
+caeuProgressEnd(CAEP_RTITEM *, PWP_BOOL)
+{
+}
+
+
+PWP_VOID
+caeuSendDebugMsg(CAEP_RTITEM *, const char *txt, PWP_UINT32 code)
+{
+    fprintf(stderr, "debug(%u): %s\n", (unsigned)code, txt);
+}
+
+
+PWP_VOID
+caeuSendInfoMsg(CAEP_RTITEM *, const char *txt, PWP_UINT32 code)
+{
+    fprintf(stderr, "info(%u): %s\n", (unsigned)code, txt);
+}
+
+
+PWP_VOID
+caeuSendWarningMsg(CAEP_RTITEM *, const char *txt, PWP_UINT32 code)
+{
+    fprintf(stderr, "warning(%u): %s\n", (unsigned)code, txt);
+}
+
+
+PWP_VOID
+caeuSendErrorMsg(CAEP_RTITEM *, const char *txt, PWP_UINT32 code)
+{
+    fprintf(stderr, "error(%u): %s\n", (unsigned)code, txt);
+}
+
+
+PWP_BOOL
+caeuAssignInfoValue(const char *, const char *, bool)
+{
+    return PWP_TRUE;
+}
+
+
+PWP_BOOL
+caeuPublishValueDefinition(const char *, PWP_ENUM_VALTYPE, const char *,
+    const char *, const char *, const char *)
+{
+    return PWP_TRUE;
+}
+
+
+/***************************************************************************/
+/* Platform file functions                                                 */
+/***************************************************************************/
+
+FILE *
+pwpFileOpen(const char *filename, int mode)
+{
+    const char *fmode = (mode & pwpBinary) ? "wb" : "w";
+    if (mode & pwpRead) {
+        fmode = (mode & pwpBinary) ? "rb" : "r";
+    }
+    return fopen(filename, fmode);
+}
+
+
+int
+pwpFileClose(FILE *fp)
+{
+    return fclose(fp);
+}
+
+
+size_t
+pwpFileWrite(const void *buf, size_t size, size_t count, FILE *fp)
+{
+    return fwrite(buf, size, count, fp);
+}
+
+
+int
+pwpFileDelete(const char *filename)
+{
+    return remove(filename);
+}
+
+/****************************************************************************
+ *
+ * This file is licensed under the Cadence Public License Version 1.0 (the
+ * "License"), a copy of which is found in the included file named "LICENSE",
+ * and is distributed "AS IS." TO THE MAXIMUM EXTENT PERMITTED BY APPLICABLE
+ * LAW, CADENCE DISCLAIMS ALL WARRANTIES AND IN NO EVENT SHALL BE LIABLE TO
+ * ANY PARTY FOR ANY DAMAGES ARISING OUT OF OR RELATING TO USE OF THIS FILE.
+ * Please see the License for the full text of applicable terms.
+ *
+ ****************************************************************************/
@@ -0,0 +1,127 @@
+/****************************************************************************
+ *
+ * (C) 2021 Cadence Design Systems, Inc. All rights reserved worldwide.
+ *
+ * This sample source code is not supported by Cadence Design Systems, Inc.
+ * It is provided freely for demonstration purposes only.
+ * SEE THE WARRANTY DISCLAIMER AT THE BOTTOM OF THIS FILE.
+ *
+ ***************************************************************************/
+/****************************************************************************
+ *
+ * In-process stand-in for the Pointwise grid model used to benchmark
+ * runtimeWrite() without a Pointwise session
+ *
+ ***************************************************************************/
+
+#ifndef _GRIDMODELSTANDIN_H_
+#define _GRIDMODELSTANDIN_H_
+
+#include "apiGridModel.h"
+
+#include <vector>
+
+
+// Cell shape of a synthetic mesh. Every hex cell of the ni x nj x nk box is
+// either kept or split into 6 tets, 2 prisms or 6 pyramids (which adds one
+// vertex at each cell center).
+enum SiMeshType {
+    SiHex,
+    SiTet,
+    SiPrism,
+    SiPyramid
+};
+
+
+struct SiConfig {
+    SiConfig() :
+        type(SiHex),
+        ni(10),
+        nj(10),
+        nk(10),
+        blocks(1),
+        domainsPerSide(1),
+        baffle(false),
+        vcTid(5),
+        firstBcTid(0),
+        scale(1.0),
+        abortAfter(0)
+    {
+    }
+
+    // Mesh cell shape
+    SiMeshType  type;
+
+    // Number of hex cells in each direction of the box
+    PWP_UINT32  ni;
+    PWP_UINT32  nj;
+    PWP_UINT32  nk;
+
+    // Number of blocks. The box is split into slabs along k.
+    PWP_UINT32  blocks;
+
+    // Number of BC domains on each of the 6 box sides. Each side is split
+    // into strips. BC types are assigned round-robin from a fixed list.
+    PWP_UINT32  domainsPerSide;
+
+    // If true, one more BC domain covers the interior k plane at nk / 2.
+    // Its faces have a cell on each side. The stream gives the lower
+    // element as the owner.
+    bool        baffle;
+
+    // VC type id of every block
+    PWP_UINT32  vcTid;
+
+    // If not 0, BC type id of the first domain instead of the first one of
+    // the round-robin list. Changes a BC without changing the grid.
+    PWP_UINT32  firstBcTid;
+
+    // Factor applied to every coordinate. Changes the grid without changing
+    // any count.
+    double      scale;
+
+    // If not 0, simulate a user cancel at the abortAfter'th progress
+    // increment
+    PWP_UINT32  abortAfter;
+};
+
+
+// Progress step recorded between caeuProgressBeginStep() and
+// caeuProgressEndStep()
+struct SiStep {
+    // Step total passed to caeuProgressBeginStep()
+    PWP_UINT32  total;
+
+    // Number of caeuProgressIncr() calls made during the step
+    PWP_UINT32  incrs;
+
+    // Wall time from begin to end in seconds
+    double      seconds;
+};
+typedef std::vector<SiStep> SiStepVec;
+
+
+PWGM_HGRIDMODEL siCreateModel(const SiConfig &cfg);
+PWP_VOID        siDestroyModel(PWGM_HGRIDMODEL model);
+
+// Sets an export attribute that runtimeWrite() reads with
+// PwModGetAttributeXxx()
+PWP_VOID        siSetAttribute(PWGM_HGRIDMODEL model, const char *name,
+                    const char *val);
+
+// Progress steps recorded since the last siResetSteps()
+const SiStepVec &siSteps();
+PWP_VOID        siResetSteps();
+
+#endif /* _GRIDMODELSTANDIN_H_ */
+
+/****************************************************************************
+ *
+ * This file is licensed under the Cadence Public License Version 1.0 (the
+ * "License"), a copy of which is found in the included file named "LICENSE",
+ * and is distributed "AS IS." TO THE MAXIMUM EXTENT PERMITTED BY APPLICABLE
+ * LAW, CADENCE DISCLAIMS ALL WARRANTIES AND IN NO EVENT SHALL BE LIABLE TO
+ * ANY PARTY FOR ANY DAMAGES ARISING OUT OF OR RELATING TO USE OF THIS FILE.
+ * Please see the License for the full text of applicable terms.
+ *
+ ****************************************************************************/
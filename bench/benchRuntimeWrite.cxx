@@ -0,0 +1,1116 @@
+/****************************************************************************
+ *
+ * (C) 2021 Cadence Design Systems, Inc. All rights reserved worldwide.
+ *
+ * This sample source code is not supported by Cadence Design Systems, Inc.
+ * It is provided freely for demonstration purposes only.
+ * SEE THE WARRANTY DISCLAIMER AT THE BOTTOM OF THIS FILE.
+ *
+ ***************************************************************************/
+/****************************************************************************
+ *
+ * runtimeWrite() throughput benchmark
+ *
+ * Exports a synthetic mesh from the grid model stand-in and reports the
+ * throughput of each REST file section.
+ *
+ ***************************************************************************/
+
+#include "apiCAEP.h"
+#include "apiCAEPUtils.h"
+#include "runtimeWrite.h"
+
+#include "rtCaepSupportData.h"
+
+#include "GridModelStandIn.h"
+#include "ADSNumFormat.h"
+#include "ADSOrderedPipeline.h"
+#include "ADSRestReader.h"
+#include "ADSSimd.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+
+typedef std::pair<std::string, std::string> Attr;
+typedef std::vector<Attr> AttrVec;
+
+struct BenchArgs {
+    BenchArgs() :
+        out("bench-out"),
+        binary(true),
+        ascii(true),
+        precision(PWP_PRECISION_SINGLE),
+        repeat(1),
+        keep(false),
+        selfTest(false)
+    {
+    }
+
+    SiConfig    cfg;
+    AttrVec     attrs;
+    std::string out;
+    bool        binary;
+    bool        ascii;
+    PWP_ENUM_PRECISION precision;
+    int         repeat;
+    bool        keep;
+    bool        selfTest;
+};
+
+
+// Record count, byte count, time and grid model calls of one export stage
+struct Stage {
+    std::string name;
+    PWP_UINT64  items;
+    PWP_UINT64  bytes;
+    double      seconds;
+    PWP_UINT64  gridCalls;
+};
+
+typedef std::vector<Stage> StageVec;
+
+static void
+usage(const char *exe)
+{
+    printf(
+        "usage: %s [options] [Attribute=Value ...]\n"
+        "  --type hex|tet|prism|pyramid  cell shape (default hex)\n"
+        "  --size NI NJ NK               hex cells in the box (default 10)\n"
+        "  --blocks N                    number of blocks (default 1)\n"
+        "  --bc-domains-per-side N       BC domains per box side "
+        "(default 1)\n"
+        "  --baffle                      add an interior BC domain\n"
+        "  --vc-tid N                    VC type id of every block "
+        "(default 5)\n"
+        "  --first-bc-tid N              BC type id of the first domain\n"
+        "  --encoding binary|ascii|both  REST encoding (default both)\n"
+        "  --precision single|double     vertex precision (default single)\n"
+        "  --repeat N                    runs per encoding, best is shown "
+        "(default 1)\n"
+        "  --abort-after N               cancel at the Nth progress step\n"
+        "  --out BASE                    output file base name "
+        "(default bench-out)\n"
+        "  --keep                        keep the exported files\n"
+        "  --self-test                   check the chunk arithmetic near "
+        "2^32 items,\n"
+        "                                the SIMD kernels, the ASCII number "
+        "formats,\n"
+        "                                the FaceHash BC faces, "
+        "incremental reuse and\n"
+        "                                the partition files\n"
+        "Attribute=Value pairs set export attributes (for example\n"
+        "WriterThreads=4). StageStats is always Json, since the stage table\n"
+        "is read from the export's stats file.\n", exe);
+}
+
+
+static bool
+parseArgs(int argc, char **argv, BenchArgs &args)
+{
+    for (int i = 1; i < argc; ++i) {
+        const std::string a(argv[i]);
+        const bool hasVal = (i + 1 < argc);
+        if ("--type" == a && hasVal) {
+            const std::string t(argv[++i]);
+            if ("hex" == t) {
+                args.cfg.type = SiHex;
+            }
+            else if ("tet" == t) {
+                args.cfg.type = SiTet;
+            }
+            else if ("prism" == t) {
+                args.cfg.type = SiPrism;
+            }
+            else if ("pyramid" == t) {
+                args.cfg.type = SiPyramid;
+            }
+            else {
+                return false;
+            }
+        }
+        else if ("--size" == a && i + 3 < argc) {
+            args.cfg.ni = PWP_UINT32(atoi(argv[++i]));
+            args.cfg.nj = PWP_UINT32(atoi(argv[++i]));
+            args.cfg.nk = PWP_UINT32(atoi(argv[++i]));
+        }
+        else if ("--blocks" == a && hasVal) {
+            args.cfg.blocks = PWP_UINT32(atoi(argv[++i]));
+        }
+        else if ("--bc-domains-per-side" == a && hasVal) {
+            args.cfg.domainsPerSide = PWP_UINT32(atoi(argv[++i]));
+        }
+        else if ("--baffle" == a) {
+            args.cfg.baffle = true;
+        }
+        else if ("--vc-tid" == a && hasVal) {
+            args.cfg.vcTid = PWP_UINT32(atoi(argv[++i]));
+        }
+        else if ("--first-bc-tid" == a && hasVal) {
+            args.cfg.firstBcTid = PWP_UINT32(atoi(argv[++i]));
+        }
+        else if ("--encoding" == a && hasVal) {
+            const std::string e(argv[++i]);
+            args.binary = ("binary" == e || "both" == e);
+            args.ascii = ("ascii" == e || "both" == e);
+            if (!args.binary && !args.ascii) {
+                return false;
+            }
+        }
+        else if ("--precision" == a && hasVal) {
+            const std::string p(argv[++i]);
+            if ("single" == p) {
+                args.precision = PWP_PRECISION_SINGLE;
+            }
+            else if ("double" == p) {
+                args.precision = PWP_PRECISION_DOUBLE;
+            }
+            else {
+                return false;
+            }
+        }
+        else if ("--repeat" == a && hasVal) {
+            args.repeat = atoi(argv[++i]);
+            if (args.repeat < 1) {
+                args.repeat = 1;
+            }
+        }
+        else if ("--abort-after" == a && hasVal) {
+            args.cfg.abortAfter = PWP_UINT32(atoi(argv[++i]));
+        }
+        else if ("--out" == a && hasVal) {
+            args.out = argv[++i];
+        }
+        else if ("--keep" == a) {
+            args.keep = true;
+        }
+        else if ("--self-test" == a) {
+            args.selfTest = true;
+        }
+        else if (std::string::npos != a.find('=') && '-' != a[0]) {
+            const size_t eq = a.find('=');
+            args.attrs.push_back(Attr(a.substr(0, eq), a.substr(eq + 1)));
+        }
+        else {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+static PWP_UINT64
+fileSize(const std::string &fname)
+{
+    PWP_UINT64 ret = 0;
+    FILE *fp = fopen(fname.c_str(), "rb");
+    if (0 != fp) {
+        if (0 == fseek(fp, 0, SEEK_END)) {
+            ret = PWP_UINT64(ftell(fp));
+        }
+        fclose(fp);
+    }
+    return ret;
+}
+
+
+// Gets the name of the REST file written by the last export. Compressed
+// exports write REST.gz.
+static std::string
+restFileName(const BenchArgs &args)
+{
+    const std::string gzName = args.out + ".REST.gz";
+    FILE *fp = fopen(gzName.c_str(), "rb");
+    if (0 != fp) {
+        fclose(fp);
+        return gzName;
+    }
+    return args.out + ".REST";
+}
+
+
+// Gets the number of REST partition files written by an export
+static unsigned
+partitionCount(const BenchArgs &args)
+{
+    unsigned ret = 1;
+    for (size_t i = 0; i < args.attrs.size(); ++i) {
+        if ("Partitions" == args.attrs[i].first) {
+            ret = unsigned(atoi(args.attrs[i].second.c_str()));
+        }
+    }
+    return (0 == ret) ? 1 : ret;
+}
+
+
+// Gets the name of a file of REST partition k (1-based)
+static std::string
+partitionFileName(const BenchArgs &args, unsigned k, const char *ext)
+{
+    char buf[32];
+    sprintf(buf, ".P%u.%s", k, ext);
+    return args.out + buf;
+}
+
+
+// Gets the total size of the REST or REST partition files
+static PWP_UINT64
+restOutputSize(const BenchArgs &args)
+{
+    const unsigned partCnt = partitionCount(args);
+    if (1 == partCnt) {
+        return fileSize(restFileName(args));
+    }
+    PWP_UINT64 ret = 0;
+    for (unsigned k = 1; k <= partCnt; ++k) {
+        ret += fileSize(partitionFileName(args, k, "REST")) +
+            fileSize(partitionFileName(args, k, "MAP"));
+    }
+    return ret;
+}
+
+
+// Gets the size of the REST partition files. The partFiles stage also
+// counts the MAP files.
+static PWP_UINT64
+partitionRestSize(const BenchArgs &args)
+{
+    PWP_UINT64 ret = 0;
+    for (unsigned k = 1; k <= partitionCount(args); ++k) {
+        ret += fileSize(partitionFileName(args, k, "REST"));
+    }
+    return ret;
+}
+
+
+// Reads the stages of the export from the StageStats=Json file. Returns
+// false if the file is missing.
+static bool
+readStages(const BenchArgs &args, StageVec &stages)
+{
+    stages.clear();
+    FILE *fp = fopen((args.out + ".stats.json").c_str(), "rb");
+    if (0 == fp) {
+        return false;
+    }
+    char line[512];
+    while (0 != fgets(line, sizeof(line), fp)) {
+        char name[64];
+        double wall;
+        double cpu;
+        unsigned long long bytes;
+        unsigned long long records;
+        unsigned long long calls;
+        if (6 == sscanf(line, " { \"name\": \"%63[^\"]\", \"wallSec\": %lf, "
+                "\"cpuSec\": %lf, \"bytes\": %llu, \"records\": %llu, "
+                "\"gridCalls\": %llu", name, &wall, &cpu, &bytes, &records,
+                &calls)) {
+            Stage st;
+            st.name = name;
+            st.items = records;
+            st.bytes = bytes;
+            st.seconds = wall;
+            st.gridCalls = calls;
+            if ("partFiles" == st.name) {
+                st.bytes = partitionRestSize(args);
+            }
+            stages.push_back(st);
+        }
+    }
+    fclose(fp);
+    return true;
+}
+
+
+// Runs one export. Returns false if runtimeWrite() fails. The stage times
+// come from the export's own stage statistics, so they are right whichever
+// optional stages (vertex and cell ordering, partitioning) run.
+static bool
+runExport(const BenchArgs &args, PWP_ENUM_ENCODING encoding,
+    StageVec &stages, double &totalSeconds)
+{
+    PWGM_HGRIDMODEL model = siCreateModel(args.cfg);
+    for (size_t i = 0; i < args.attrs.size(); ++i) {
+        siSetAttribute(model, args.attrs[i].first.c_str(),
+            args.attrs[i].second.c_str());
+    }
+    siSetAttribute(model, "StageStats", "Json");
+
+    CAEP_WRITEINFO writeInfo;
+    writeInfo.fileDest = args.out.c_str();
+    writeInfo.conditionsOnly = PWP_FALSE;
+    writeInfo.encoding = encoding;
+    writeInfo.precision = args.precision;
+    writeInfo.dimension = PWP_DIMENSION_3D;
+
+    CAEP_RTITEM rti;
+    memset(&rti, 0, sizeof(rti));
+    rti.pBCInfo = CaeUnsADSBCInfo;
+    rti.BCCnt = ARRAYSIZE(CaeUnsADSBCInfo);
+    rti.pVCInfo = CaeUnsADSVCInfo;
+    rti.VCCnt = ARRAYSIZE(CaeUnsADSVCInfo);
+    rti.model = model;
+    rti.pWriteInfo = &writeInfo;
+
+    // restFileName() must not find a REST.gz left by an earlier run and
+    // readStages() must not find an old stats file
+    remove((args.out + ".REST.gz").c_str());
+    remove((args.out + ".stats.json").c_str());
+
+    siResetSteps();
+    runtimeCreate(&rti);
+    const std::chrono::steady_clock::time_point start =
+        std::chrono::steady_clock::now();
+    const bool ret = (0 != runtimeWrite(&rti, model, &writeInfo));
+    const std::chrono::duration<double> dt =
+        std::chrono::steady_clock::now() - start;
+    runtimeDestroy(&rti);
+    siDestroyModel(model);
+    totalSeconds = dt.count();
+    return readStages(args, stages) && ret;
+}
+
+
+static void
+printStage(const Stage &st)
+{
+    const double mb = double(st.bytes) / (1024.0 * 1024.0);
+    const double t = (st.seconds > 0.0) ? st.seconds : 1.0e-9;
+    printf("  %-13s %12llu %14llu %10.4f %10.1f %12.0f\n", st.name.c_str(),
+        (unsigned long long)st.items, (unsigned long long)st.bytes,
+        st.seconds, mb / t, double(st.items) / t);
+}
+
+
+static bool
+benchEncoding(const BenchArgs &args, PWP_ENUM_ENCODING encoding)
+{
+    StageVec best;
+    double bestTotal = 0.0;
+    for (int r = 0; r < args.repeat; ++r) {
+        StageVec stages;
+        double total;
+        if (!runExport(args, encoding, stages, total)) {
+            printf("%s: export failed or was aborted\n",
+                PWP_ENCODING_BINARY == encoding ? "binary" : "ascii");
+            return false;
+        }
+        // every run has the same stages in the same order
+        for (size_t s = 0; s < stages.size(); ++s) {
+            if (s == best.size()) {
+                best.push_back(stages[s]);
+            }
+            else if (stages[s].seconds < best[s].seconds) {
+                best[s] = stages[s];
+            }
+        }
+        if (0 == r || total < bestTotal) {
+            bestTotal = total;
+        }
+    }
+
+    printf("%s REST:\n", PWP_ENCODING_BINARY == encoding ? "binary" :
+        "ascii");
+    printf("  %-13s %12s %14s %10s %10s %12s\n", "stage", "items", "bytes",
+        "seconds", "MB/s", "items/s");
+    for (size_t s = 0; s < best.size(); ++s) {
+        printStage(best[s]);
+    }
+    printf("  %-13s %12s %14llu %10.4f\n", "all files", "",
+        (unsigned long long)restOutputSize(args), bestTotal);
+    return true;
+}
+
+static void
+removeOutput(const BenchArgs &args)
+{
+    remove((args.out + ".REST").c_str());
+    remove((args.out + ".REST.gz").c_str());
+    remove((args.out + ".REST.manifest").c_str());
+    remove((args.out + ".BCVAL").c_str());
+    remove((args.out + ".BCTYPE").c_str());
+    remove((args.out + ".stats.json").c_str());
+    for (unsigned k = 1; k <= partitionCount(args); ++k) {
+        remove(partitionFileName(args, k, "REST").c_str());
+        remove(partitionFileName(args, k, "MAP").c_str());
+    }
+}
+
+
+typedef std::pair<PWP_UINT32, PWP_UINT32> Range;
+typedef std::vector<Range> RangeVec;
+
+
+// True if the sorted ranges cover [beg, end) without gaps or overlaps
+static bool
+coversRange(RangeVec ranges, PWP_UINT32 beg, PWP_UINT32 end)
+{
+    std::sort(ranges.begin(), ranges.end());
+    PWP_UINT64 next = beg;
+    for (size_t i = 0; i < ranges.size(); ++i) {
+        if (ranges[i].first != next || ranges[i].second <= ranges[i].first) {
+            return false;
+        }
+        next = ranges[i].second;
+    }
+    return next == end;
+}
+
+
+static bool
+check(bool ok, const char *what)
+{
+    printf("  %-44s %s\n", what, (ok ? "ok" : "FAILED"));
+    return ok;
+}
+
+
+// Reads a whole file. Returns an empty string if it cannot be read.
+static std::string
+readFile(const std::string &fname)
+{
+    std::string ret;
+    FILE *fp = fopen(fname.c_str(), "rb");
+    if (0 != fp) {
+        char buf[65536];
+        size_t n;
+        while (0 != (n = fread(buf, 1, sizeof(buf), fp))) {
+            ret.append(buf, n);
+        }
+        fclose(fp);
+    }
+    return ret;
+}
+
+
+// Exports a model with a baffle with each BC face engine and checks that
+// the REST files are the same. A baffle face has a cell on each side, so
+// this checks the face hash's "lowest element wins" owner rule against the
+// owner PwModStreamFaces() gives.
+static bool
+sameBcFaceEngines(SiMeshType type)
+{
+    static const char *Engines[2] = { "Stream", "FaceHash" };
+    std::string rest[2];
+    bool ok = true;
+    for (int i = 0; i < 2; ++i) {
+        BenchArgs args;
+        args.cfg.type = type;
+        args.cfg.ni = 5;
+        args.cfg.nj = 4;
+        args.cfg.nk = 6;
+        args.cfg.blocks = 2;
+        args.cfg.domainsPerSide = 2;
+        args.cfg.baffle = true;
+        args.out = std::string("bench-self-test-") + Engines[i];
+        args.attrs.push_back(Attr("BcFaceEngine", Engines[i]));
+        args.attrs.push_back(Attr("Validate", "true"));
+        StageVec stages;
+        double seconds;
+        ok = runExport(args, PWP_ENCODING_BINARY, stages, seconds) && ok;
+        for (size_t s = 0; s < stages.size(); ++s) {
+            // the face hash falls back to the stream, which is 1 call
+            if ("bcFaces" == stages[s].name && 1 == i) {
+                ok = (stages[s].gridCalls > 1) && ok;
+            }
+        }
+        rest[i] = readFile(args.out + ".REST");
+        removeOutput(args);
+    }
+    return ok && !rest[0].empty() && rest[0] == rest[1];
+}
+
+
+// True if the stage named name made fewer grid model calls than it has
+// records. A written section makes 2 calls per record. A copied one only
+// reads a sample of the grid. The BC face stream is 1 call if the owner
+// types are cached.
+static bool
+fewGridCalls(const StageVec &stages, const char *name)
+{
+    for (size_t s = 0; s < stages.size(); ++s) {
+        if (name == stages[s].name) {
+            return stages[s].gridCalls < stages[s].items;
+        }
+    }
+    return false;
+}
+
+
+// True if rest matches the REST file of a full export of args' model
+static bool
+sameAsFullExport(BenchArgs args, const std::string &rest)
+{
+    args.attrs.clear();
+    StageVec stages;
+    double seconds;
+    const bool ok = runExport(args, PWP_ENCODING_BINARY, stages, seconds);
+    const std::string full = readFile(args.out + ".REST");
+    removeOutput(args);
+    return ok && !rest.empty() && rest == full;
+}
+
+
+// Exports a model incrementally, changes the BC type of one domain and
+// exports it again. The second export must copy the vertex and
+// connectivity sections and find the BC face owner types in the cell type
+// cache. Its REST file must match a full export of the changed model.
+static bool
+reusesSectionsOnBcEdit()
+{
+    BenchArgs args;
+    args.cfg.type = SiPrism;
+    args.cfg.ni = 8;
+    args.cfg.nj = 6;
+    args.cfg.nk = 5;
+    args.cfg.blocks = 2;
+    args.cfg.domainsPerSide = 2;
+    args.out = "bench-self-test-incremental";
+    args.attrs.push_back(Attr("IncrementalExport", "true"));
+    args.attrs.push_back(Attr("ModelRevision", "r1"));
+    StageVec stages;
+    double seconds;
+    bool ok = runExport(args, PWP_ENCODING_BINARY, stages, seconds);
+    args.cfg.firstBcTid = 3;
+    ok = runExport(args, PWP_ENCODING_BINARY, stages, seconds) && ok;
+    ok = fewGridCalls(stages, "vertices") &&
+        fewGridCalls(stages, "connectivity") &&
+        fewGridCalls(stages, "bcFaces") && ok;
+    const std::string rest = readFile(args.out + ".REST");
+    removeOutput(args);
+    return sameAsFullExport(args, rest) && ok;
+}
+
+
+// Exports a model incrementally, scales its coordinates and exports it
+// again with the same ModelRevision. The vertex sample must catch the
+// change, so the vertex section is written again.
+static bool
+rewritesChangedGrid()
+{
+    BenchArgs args;
+    args.cfg.type = SiTet;
+    args.cfg.ni = 5;
+    args.cfg.nj = 6;
+    args.cfg.nk = 4;
+    args.out = "bench-self-test-incremental";
+    args.attrs.push_back(Attr("IncrementalExport", "true"));
+    args.attrs.push_back(Attr("ModelRevision", "r1"));
+    StageVec stages;
+    double seconds;
+    bool ok = runExport(args, PWP_ENCODING_BINARY, stages, seconds);
+    args.cfg.scale = 2.0;
+    ok = runExport(args, PWP_ENCODING_BINARY, stages, seconds) && ok;
+    ok = !fewGridCalls(stages, "vertices") &&
+        fewGridCalls(stages, "connectivity") && ok;
+    const std::string rest = readFile(args.out + ".REST");
+    removeOutput(args);
+    return sameAsFullExport(args, rest) && ok;
+}
+
+
+// Map file of one REST partition: the global vertex and cell numbers of the
+// local ones and the interface records, all 1-based
+struct PartitionMap {
+    PWP_UINT32              header[5];
+    std::vector<PWP_UINT32> verts;
+    std::vector<PWP_UINT32> cells;
+    std::vector<PWP_UINT32> ifRecs;
+};
+
+
+// Reads a binary map file with 32-bit integers. Returns false if its size
+// does not match its header.
+static bool
+readPartitionMap(const std::string &fname, PartitionMap &map)
+{
+    const std::string data = readFile(fname);
+    const size_t hdrSize = sizeof(map.header);
+    if (data.size() < hdrSize) {
+        return false;
+    }
+    memcpy(map.header, data.data(), hdrSize);
+    map.verts.resize(map.header[2]);
+    map.cells.resize(map.header[3]);
+    map.ifRecs.resize(3 * size_t(map.header[4]));
+    const size_t vertSize = map.verts.size() * sizeof(PWP_UINT32);
+    const size_t cellSize = map.cells.size() * sizeof(PWP_UINT32);
+    const size_t ifSize = map.ifRecs.size() * sizeof(PWP_UINT32);
+    if (data.size() != hdrSize + vertSize + cellSize + ifSize) {
+        return false;
+    }
+    const char *p = data.data() + hdrSize;
+    memcpy(map.verts.data(), p, vertSize);
+    memcpy(map.cells.data(), p + vertSize, cellSize);
+    memcpy(map.ifRecs.data(), p + vertSize + cellSize, ifSize);
+    return true;
+}
+
+
+// Exports a model in partCnt partitions and as one REST file and checks the
+// partitions against the single file: every cell is in exactly one
+// partition, the local connectivity and BC faces mapped back to global
+// numbers match, and each interface record names the same global vertex
+// in both partitions. Every vertex shared by p partitions must have p - 1
+// interface records in each of them.
+static bool
+partitionsMatchGlobal(SiMeshType type, unsigned partCnt)
+{
+    typedef std::vector<PWP_UINT64> UINT64Vec;
+    BenchArgs args;
+    args.cfg.type = type;
+    args.cfg.ni = 7;
+    args.cfg.nj = 5;
+    args.cfg.nk = 4;
+    args.cfg.blocks = 2;
+    args.cfg.domainsPerSide = 2;
+    args.cfg.baffle = true;
+    args.out = "bench-self-test-partitions";
+    char buf[16];
+    sprintf(buf, "%u", partCnt);
+    args.attrs.push_back(Attr("Partitions", buf));
+    StageVec stages;
+    double seconds;
+    bool ok = runExport(args, PWP_ENCODING_BINARY, stages, seconds);
+    std::vector<PartitionMap> maps(partCnt);
+    // per partition: each cell's 8 global vertices and each BC face as
+    // global cellID, face and tid
+    std::vector<UINT64Vec> conn(partCnt);
+    std::vector<UINT64Vec> bcFaces(partCnt);
+    for (unsigned k = 0; k < partCnt && ok; ++k) {
+        PartitionMap &map = maps[k];
+        ADSRestReader rest;
+        ok = readPartitionMap(partitionFileName(args, k + 1, "MAP"), map) &&
+            rest.open(partitionFileName(args, k + 1, "REST").c_str(),
+                sizeof(PWP_UINT32), sizeof(float)) &&
+            map.header[0] == partCnt && map.header[1] == k + 1 &&
+            rest.getNNL() == map.verts.size() &&
+            rest.getNEL() == map.cells.size();
+        for (PWP_UINT64 e = 0; e < rest.getNEL() && ok; ++e) {
+            for (size_t j = 0; j < ADSRestReader::ElemValues && ok; ++j) {
+                const PWP_UINT64 l = rest.elemValue(e, j);
+                ok = (l >= 1 && l <= map.verts.size());
+                conn[k].push_back(ok ? map.verts[l - 1] : 0);
+            }
+        }
+        for (PWP_UINT64 f = 0; f < rest.getNBCL() && ok; ++f) {
+            const PWP_UINT64 c = rest.bcValue(f, 0);
+            ok = (c >= 1 && c <= map.cells.size());
+            bcFaces[k].push_back(ok ? map.cells[c - 1] : 0);
+            bcFaces[k].push_back(rest.bcValue(f, 1));
+            bcFaces[k].push_back(rest.bcValue(f, 2));
+        }
+    }
+    removeOutput(args);
+
+    args.attrs.clear();
+    ok = runExport(args, PWP_ENCODING_BINARY, stages, seconds) && ok;
+    ADSRestReader global;
+    ok = global.open((args.out + ".REST").c_str(), sizeof(PWP_UINT32),
+        sizeof(float)) && ok;
+    // partitions using each global vertex and each cell
+    std::vector<PWP_UINT32> vertUses(size_t(global.getNNL()), 0);
+    std::vector<PWP_UINT32> cellUses(size_t(global.getNEL()), 0);
+    std::vector<UINT64Vec> globalBc;
+    std::vector<UINT64Vec> localBc;
+    for (unsigned k = 0; k < partCnt && ok; ++k) {
+        const PartitionMap &map = maps[k];
+        for (size_t i = 0; i < map.cells.size() && ok; ++i) {
+            const PWP_UINT32 c = map.cells[i];
+            ok = (c >= 1 && c <= cellUses.size());
+            for (size_t j = 0; j < ADSRestReader::ElemValues && ok; ++j) {
+                ok = (conn[k][i * ADSRestReader::ElemValues + j] ==
+                    global.elemValue(c - 1, j));
+            }
+            if (ok) {
+                ++cellUses[c - 1];
+            }
+        }
+        for (size_t l = 0; l < map.verts.size() && ok; ++l) {
+            ok = (map.verts[l] >= 1 && map.verts[l] <= vertUses.size());
+            if (ok) {
+                ++vertUses[map.verts[l] - 1];
+            }
+        }
+        for (size_t f = 0; f < bcFaces[k].size(); f += 3) {
+            localBc.push_back(UINT64Vec(&bcFaces[k][f], &bcFaces[k][f] + 3));
+        }
+    }
+    for (PWP_UINT64 f = 0; f < global.getNBCL() && ok; ++f) {
+        UINT64Vec rec(3);
+        for (size_t j = 0; j < 3; ++j) {
+            rec[j] = global.bcValue(f, j);
+        }
+        globalBc.push_back(rec);
+    }
+    std::sort(globalBc.begin(), globalBc.end());
+    std::sort(localBc.begin(), localBc.end());
+    ok = ok && !cellUses.empty() && globalBc == localBc &&
+        std::count(cellUses.begin(), cellUses.end(), 1) ==
+        std::ptrdiff_t(cellUses.size());
+
+    // interface records: local vertex, neighbor partition and the vertex's
+    // local number there
+    PWP_UINT64 ifCnt = 0;
+    PWP_UINT64 wantIfCnt = 0;
+    for (size_t v = 0; v < vertUses.size(); ++v) {
+        if (vertUses[v] > 1) {
+            wantIfCnt += PWP_UINT64(vertUses[v]) * (vertUses[v] - 1);
+        }
+    }
+    for (unsigned k = 0; k < partCnt && ok; ++k) {
+        const PartitionMap &map = maps[k];
+        for (size_t r = 0; r < map.ifRecs.size() && ok; r += 3, ++ifCnt) {
+            const PWP_UINT32 l = map.ifRecs[r];
+            const PWP_UINT32 p = map.ifRecs[r + 1];
+            const PWP_UINT32 n = map.ifRecs[r + 2];
+            ok = (l >= 1 && l <= map.verts.size() && p >= 1 &&
+                p <= partCnt && p != k + 1 && n >= 1 &&
+                n <= maps[p - 1].verts.size() &&
+                map.verts[l - 1] == maps[p - 1].verts[n - 1]);
+        }
+    }
+    global.close();
+    removeOutput(args);
+    return ok && wantIfCnt > 0 && ifCnt == wantIfCnt;
+}
+
+
+// Runs the rebase kernel of level on elements of every vertex count and on
+// 0 to 33 elements, so every SIMD tail length is hit, and compares the
+// records with the scalar kernel. Each batch is run with no map, with a map
+// of half the vertices and with a map some indices are past.
+static bool
+sameRebaseKernel(ADSSimdLevel level)
+{
+    const PWP_UINT32 VertCnt = 1000;
+    const ADSRebaseFunc rebase = adsRebaseFunc(level);
+    std::mt19937 rng(1);
+    std::vector<PWP_UINT32> map(VertCnt);
+    for (PWP_UINT32 i = 0; i < VertCnt; ++i) {
+        map[i] = VertCnt - 1 - i;
+    }
+    const size_t MapSizes[3] = { 0, VertCnt / 2, VertCnt };
+    bool ok = true;
+    for (PWP_UINT32 vertCnt = 1; vertCnt <= PWGM_ELEMDATA_VERT_SIZE;
+            ++vertCnt) {
+        for (size_t n = 0; n <= 33; ++n) {
+            // the spare values after the last element are read, not used
+            std::vector<PWP_UINT32> index(n * vertCnt +
+                PWGM_ELEMDATA_VERT_SIZE);
+            for (size_t i = 0; i < index.size(); ++i) {
+                index[i] = rng() % (VertCnt + 100);
+            }
+            // write the records in reverse order
+            std::vector<PWP_UINT32> pos(n);
+            for (size_t e = 0; e < n; ++e) {
+                pos[e] = PWP_UINT32(n - 1 - e);
+            }
+            for (int m = 0; m < 3; ++m) {
+                std::vector<PWP_UINT32> want(n * PWGM_ELEMDATA_VERT_SIZE, 0);
+                std::vector<PWP_UINT32> got(want.size(), 0);
+                adsRebaseIndicesScalar(index.data(), vertCnt, pos.data(), n,
+                    map.data(), MapSizes[m], want.data());
+                rebase(index.data(), vertCnt, pos.data(), n, map.data(),
+                    MapSizes[m], got.data());
+                ok = (want == got) && ok;
+            }
+        }
+    }
+    return ok;
+}
+
+
+// Runs the narrow kernel of level on 0 to 33 vertices, so every SIMD tail
+// length is hit, with records of 3 to 9 values, and compares the bytes and
+// end pointer with the scalar kernel. Fewer than 4 values is the scalar
+// fallback. The coordinates include values that round, overflow and
+// underflow as floats.
+static bool
+sameNarrowKernel(ADSSimdLevel level)
+{
+    const ADSNarrowFunc narrow = adsNarrowFunc(level);
+    std::mt19937 rng(2);
+    std::uniform_real_distribution<double> mantissa(-1.0, 1.0);
+    std::uniform_int_distribution<int> exponent(-160, 160);
+    float rec[9];
+    for (size_t i = 0; i < 9; ++i) {
+        rec[i] = 0.25f * float(i);
+    }
+    bool ok = true;
+    for (size_t count = 3; count <= 9; ++count) {
+        for (size_t n = 0; n <= 33; ++n) {
+            std::vector<PWP_REAL> xyz(3 * n);
+            for (size_t i = 0; i < xyz.size(); ++i) {
+                xyz[i] = std::ldexp(mantissa(rng), exponent(rng));
+            }
+            const PWP_REAL *x = xyz.data();
+            const PWP_REAL *y = x + n;
+            const PWP_REAL *z = y + n;
+            std::vector<char> want(n * count * sizeof(float) + 1, 0);
+            std::vector<char> got(want.size(), 0);
+            const char *wantEnd = adsNarrowVerticesScalar(x, y, z, n, rec,
+                count, want.data());
+            const char *gotEnd = narrow(x, y, z, n, rec, count, got.data());
+            ok = (want == got) && (wantEnd - want.data() ==
+                gotEnd - got.data()) && ok;
+        }
+    }
+    return ok;
+}
+
+
+// True if fmtFloat(v) writes what sprintf(buf, "%9f", v) does
+static bool
+sameFloatFormat(float v)
+{
+    char want[MaxFmtFldLen];
+    char got[MaxFmtFldLen];
+    const int len = snprintf(want, sizeof(want), "%9f", v);
+    const char *end = fmtFloat(got, v);
+    return (end - got == len) && 0 == memcmp(want, got, size_t(len));
+}
+
+
+// True if fmtUInt(v, fldWd) writes what sprintf(buf, "%*llu", fldWd, v)
+// does
+static bool
+sameUIntFormat(PWP_UINT64 v, int fldWd)
+{
+    char want[MaxFmtFldLen];
+    char got[MaxFmtFldLen];
+    const int len = snprintf(want, sizeof(want), "%*llu", fldWd,
+        (unsigned long long)v);
+    const char *end = fmtUInt(got, v, fldWd);
+    return (end - got == len) && 0 == memcmp(want, got, size_t(len));
+}
+
+
+// Compares fmtFloat() with printf on zeros, subnormals, values that round
+// half way at the 6th decimal, the limit of the integer path, non-finite
+// values and a seeded random sweep of bit patterns and magnitudes.
+static bool
+sameFloatFormats()
+{
+    const float Inf = std::numeric_limits<float>::infinity();
+    const float Edges[] = {
+        0.0f, -0.0f, std::numeric_limits<float>::denorm_min(),
+        -std::numeric_limits<float>::denorm_min(),
+        std::numeric_limits<float>::min(), 1.0e-7f, -1.0e-7f, 4.9e-7f,
+        5.0e-7f, 5.1e-7f, -5.0e-7f, 0.999999f, 0.9999995f, 9.9999995f,
+        1.0f, -1.0f, 123456.789f, 8.9e12f, 9.0e12f, 9.1e12f, -9.1e12f,
+        1.0e30f, std::numeric_limits<float>::max(),
+        -std::numeric_limits<float>::max(), Inf, -Inf,
+        std::numeric_limits<float>::quiet_NaN()
+    };
+    bool ok = true;
+    for (size_t i = 0; i < sizeof(Edges) / sizeof(Edges[0]); ++i) {
+        ok = sameFloatFormat(Edges[i]) && ok;
+    }
+    // k / 2^7 with k odd is k * 7812.5 millionths, an exact tie that
+    // printf rounds to even
+    for (int k = -1001; k <= 1001; k += 2) {
+        ok = sameFloatFormat(std::ldexp(float(k), -7)) && ok;
+    }
+    std::mt19937 rng(3);
+    std::uniform_real_distribution<float> mantissa(-1.0f, 1.0f);
+    std::uniform_int_distribution<int> exponent(-30, 50);
+    for (int i = 0; i < 100000; ++i) {
+        PWP_UINT32 bits = PWP_UINT32(rng());
+        float v;
+        memcpy(&v, &bits, sizeof(v));
+        ok = sameFloatFormat(v) && ok;
+        ok = sameFloatFormat(std::ldexp(mantissa(rng), exponent(rng))) && ok;
+    }
+    return ok;
+}
+
+
+// Compares fmtUInt() with printf on each power of 10 and its neighbors, the
+// largest value and a seeded random sweep, in fields narrower and wider
+// than the number.
+static bool
+sameUIntFormats()
+{
+    const int Widths[] = { 0, 1, 8, 20, 25 };
+    std::vector<PWP_UINT64> values;
+    PWP_UINT64 p = 1;
+    for (int i = 0; i < 20; ++i, p *= 10) {
+        values.push_back(p - 1);
+        values.push_back(p);
+        values.push_back(p + 1);
+    }
+    values.push_back(~PWP_UINT64(0));
+    std::mt19937_64 rng(4);
+    for (int i = 0; i < 10000; ++i) {
+        values.push_back(rng() >> (rng() % 64));
+    }
+    bool ok = true;
+    for (size_t i = 0; i < values.size(); ++i) {
+        for (size_t w = 0; w < sizeof(Widths) / sizeof(Widths[0]); ++w) {
+            ok = sameUIntFormat(values[i], Widths[w]) && ok;
+        }
+    }
+    return ok;
+}
+
+
+// Runs the chunk and batch helpers the writers use on item ranges that end
+// at 0xFFFFFFFF, where 32-bit arithmetic wraps. Only the ranges are
+// recorded, so this takes no memory. Then checks the SIMD kernels this CPU
+// can run, the ASCII number formats, the face hash BC faces, the sections
+// an incremental export reuses and the partition files.
+static bool
+selfTest()
+{
+    const PWP_UINT32 Max = 0xFFFFFFFF;
+    const PWP_UINT32 BigChunk = 1 << 28;
+    printf("self test\n");
+    bool ok = true;
+
+    PWP_UINT32 beg;
+    PWP_UINT32 end;
+    adsChunkRange(adsChunkCount(Max, 32768) - 1, Max, 32768, beg, end);
+    ok = check(adsChunkCount(Max, 32768) == 131072 &&
+        adsChunkCount(Max, Max) == 1 && adsChunkCount(Max - 1, 2) == 0x7FFFFFFF
+        && beg == Max - 32767 && end == Max, "chunk count and last range") &&
+        ok;
+
+    RangeVec filled;
+    RangeVec emitted;
+    std::mutex mtx;
+    auto fill = [&](PWP_UINT32 b, PWP_UINT32 e, int &) {
+        std::lock_guard<std::mutex> lock(mtx);
+        filled.push_back(Range(b, e));
+        return true;
+    };
+    auto emit = [&](PWP_UINT32 b, PWP_UINT32 e, int &) {
+        emitted.push_back(Range(b, e));
+        return true;
+    };
+    bool ran = adsRunOrdered<int>(Max, BigChunk, 2, fill, emit);
+    ok = check(ran && coversRange(filled, 0, Max) && emitted.size() == 16 &&
+        coversRange(emitted, 0, Max) && emitted.back().second == Max,
+        "adsRunOrdered chunks") && ok;
+
+    RangeVec worked;
+    PWP_UINT64 progressed = 0;
+    auto work = [&](PWP_UINT32 b, PWP_UINT32 e) {
+        std::lock_guard<std::mutex> lock(mtx);
+        worked.push_back(Range(b, e));
+        return true;
+    };
+    auto progress = [&](PWP_UINT32 items) {
+        progressed += items;
+        return true;
+    };
+    ran = adsParallelFor(Max, BigChunk, 2, work, progress);
+    ok = check(ran && coversRange(worked, 0, Max) && progressed == Max,
+        "adsParallelFor chunks") && ok;
+
+    RangeVec batches;
+    auto batch = [&](PWP_UINT32 b, PWP_UINT32 n) {
+        batches.push_back(Range(b, b + n));
+        // never loop forever if the range does wrap
+        return batches.size() < 100;
+    };
+    ran = adsForBatches(Max - 3000, Max, 1024, batch);
+    ok = check(ran && batches.size() == 3 &&
+        coversRange(batches, Max - 3000, Max), "adsForBatches near the limit")
+        && ok;
+
+    for (int level = ADSSimdSSE2; level <= adsSimdLevel(); ++level) {
+        const ADSSimdLevel simd = ADSSimdLevel(level);
+        const std::string name = adsSimdName(simd);
+        ok = check(sameRebaseKernel(simd),
+            (name + " rebase matches scalar").c_str()) && ok;
+        ok = check(sameNarrowKernel(simd),
+            (name + " narrow matches scalar").c_str()) && ok;
+    }
+    ok = check(sameFloatFormats(), "fmtFloat matches printf") && ok;
+    ok = check(sameUIntFormats(), "fmtUInt matches printf") && ok;
+
+    ok = check(sameBcFaceEngines(SiHex), "FaceHash matches Stream (hex)") &&
+        ok;
+    ok = check(sameBcFaceEngines(SiTet), "FaceHash matches Stream (tet)") &&
+        ok;
+    ok = check(sameBcFaceEngines(SiPrism),
+        "FaceHash matches Stream (prism)") && ok;
+    ok = check(sameBcFaceEngines(SiPyramid),
+        "FaceHash matches Stream (pyramid)") && ok;
+    ok = check(reusesSectionsOnBcEdit(),
+        "BC edit reuses vertices and connectivity") && ok;
+    ok = check(rewritesChangedGrid(),
+        "grid edit without a new revision is written") && ok;
+    ok = check(partitionsMatchGlobal(SiHex, 4),
+        "4 partitions match the REST file (hex)") && ok;
+    ok = check(partitionsMatchGlobal(SiTet, 3),
+        "3 partitions match the REST file (tet)") && ok;
+    return ok;
+}
+
+
+int
+main(int argc, char **argv)
+{
+    BenchArgs args;
+    if (!parseArgs(argc, argv, args)) {
+        usage(argv[0]);
+        return 2;
+    }
+    if (args.selfTest) {
+        return selfTest() ? 0 : 1;
+    }
+    static const char *TypeNames[] = { "hex", "tet", "prism", "pyramid" };
+    printf("%s mesh %u x %u x %u cells, %u block(s), %u BC domain(s) per "
+        "side\n", TypeNames[args.cfg.type], (unsigned)args.cfg.ni,
+        (unsigned)args.cfg.nj, (unsigned)args.cfg.nk,
+        (unsigned)args.cfg.blocks, (unsigned)args.cfg.domainsPerSide);
+    for (size_t i = 0; i < args.attrs.size(); ++i) {
+        printf("  %s = %s\n", args.attrs[i].first.c_str(),
+            args.attrs[i].second.c_str());
+    }
+
+    bool ok = true;
+    if (args.binary) {
+        ok = benchEncoding(args, PWP_ENCODING_BINARY) && ok;
+    }
+    if (args.ascii) {
+        // keep the binary files if both are requested and kept
+        const BenchArgs *pArgs = &args;
+        BenchArgs asciiArgs;
+        if (args.binary && args.keep) {
+            asciiArgs = args;
+            asciiArgs.out += "-ascii";
+            pArgs = &asciiArgs;
+        }
+        ok = benchEncoding(*pArgs, PWP_ENCODING_ASCII) && ok;
+        if (!pArgs->keep) {
+            removeOutput(*pArgs);
+        }
+    }
+    if (!args.keep) {
+        removeOutput(args);
+    }
+    return ok ? 0 : 1;
+}
+
+/****************************************************************************
+ *
+ * This file is licensed under the Cadence Public License Version 1.0 (the
+ * "License"), a copy of which is found in the included file named "LICENSE",
+ * and is distributed "AS IS." TO THE MAXIMUM EXTENT PERMITTED BY APPLICABLE
+ * LAW, CADENCE DISCLAIMS ALL WARRANTIES AND IN NO EVENT SHALL BE LIABLE TO
+ * ANY PARTY FOR ANY DAMAGES ARISING OUT OF OR RELATING TO USE OF THIS FILE.
+ * Please see the License for the full text of applicable terms.
+ *
+ ****************************************************************************/
@@ -0,0 +1,81 @@
+/****************************************************************************
+ *
+ * (C) 2021 Cadence Design Systems, Inc. All rights reserved worldwide.
+ *
+ * This sample source code is not supported by Cadence Design Systems, Inc.
+ * It is provided freely for demonstration purposes only.
+ * SEE THE WARRANTY DISCLAIMER AT THE BOTTOM OF THIS FILE.
+ *
+ ***************************************************************************/
+/****************************************************************************
+ *
+ * Pointwise CAE Plugin API (CAEP-API)
+ *
+ * Benchmark stand-in for the PluginSDK header of the same name. Declares
+ * only what runtimeWrite.cxx uses, with the same names and signatures.
+ *
+ ***************************************************************************/
+
+#ifndef _APICAEP_H_
+#define _APICAEP_H_
+
+#include "apiPWP.h"
+#include "apiGridModel.h"
+#include "rtCaepInstanceData.h"
+
+typedef struct CAEP_BCINFO_t {
+    const char *phystype;
+    PWP_UINT32  id;
+} CAEP_BCINFO;
+
+typedef struct CAEP_VCINFO_t {
+    const char *phystype;
+    PWP_UINT32  id;
+} CAEP_VCINFO;
+
+typedef struct CAEP_WRITEINFO_t {
+    const char *        fileDest;
+    PWP_BOOL            conditionsOnly;
+    PWP_ENUM_ENCODING   encoding;
+    PWP_ENUM_PRECISION  precision;
+    PWP_ENUM_DIMENSION  dimension;
+} CAEP_WRITEINFO;
+
+enum {
+    CAEPU_CLKS_ID,
+    CAEPU_CLKS_PROGUPDATE,
+    CAEPU_CLKS_PROGINIT,
+    CAEPU_CLKS_BEGSTEP,
+    CAEPU_CLKS_PROGINCR,
+    CAEPU_CLKS_ENDSTEP,
+    CAEPU_CLKS_PROGEND,
+    CAEPU_CLKS_SIZE
+};
+
+typedef struct CAEP_RTITEM_t {
+    CAEP_BCINFO *           pBCInfo;
+    PWP_UINT32              BCCnt;
+    CAEP_VCINFO *           pVCInfo;
+    PWP_UINT32              VCCnt;
+    FILE *                  fp;
+    PWGM_HGRIDMODEL         model;
+    const CAEP_WRITEINFO *  pWriteInfo;
+    PWP_UINT32              progTotal;
+    PWP_UINT32              progComplete;
+    clock_t                 clocks[CAEPU_CLKS_SIZE];
+    PWP_BOOL                opAborted;
+    CAEP_RUNTIME_INSTDATADECL
+} CAEP_RTITEM;
+
+#endif /* _APICAEP_H_ */
+
+/****************************************************************************
+ *
+ * This file is licensed under the Cadence Public License Version 1.0 (the
+ * "License"), a copy of which is found in the included file named "LICENSE",
+ * and is distributed "AS IS." TO THE MAXIMUM EXTENT PERMITTED BY APPLICABLE
+ * LAW, CADENCE DISCLAIMS ALL WARRANTIES AND IN NO EVENT SHALL BE LIABLE TO
+ * ANY PARTY FOR ANY DAMAGES ARISING OUT OF OR RELATING TO USE OF THIS FILE.
+ * Please see the License for the full text of applicable terms.
+ *
+ ****************************************************************************/
@@ -0,0 +1,64 @@
+/****************************************************************************
+ *
+ * (C) 2021 Cadence Design Systems, Inc. All rights reserved worldwide.
+ *
+ * This sample source code is not supported by Cadence Design Systems, Inc.
+ * It is provided freely for demonstration purposes only.
+ * SEE THE WARRANTY DISCLAIMER AT THE BOTTOM OF THIS FILE.
+ *
+ ***************************************************************************/
+/****************************************************************************
+ *
+ * CAEP-API utility functions
+ *
+ * Benchmark stand-in for the PluginSDK header of the same name. Declares
+ * only what runtimeWrite.cxx uses, with the same names and signatures.
+ *
+ ***************************************************************************/
+
+#ifndef _APICAEPUTILS_H_
+#define _APICAEPUTILS_H_
+
+#include "apiCAEP.h"
+
+#define CAEPU_RT_ENC_ASCII(pRti) \
+            (PWP_ENCODING_ASCII == (pRti)->pWriteInfo->encoding)
+#define CAEPU_RT_ENC_BINARY(pRti) \
+            (PWP_ENCODING_BINARY == (pRti)->pWriteInfo->encoding)
+#define CAEPU_RT_PREC_SINGLE(pRti) \
+            (PWP_PRECISION_SINGLE == (pRti)->pWriteInfo->precision)
+#define CAEPU_RT_PREC_DOUBLE(pRti) \
+            (PWP_PRECISION_DOUBLE == (pRti)->pWriteInfo->precision)
+#define CAEPU_RT_IS_ABORTED(pRti)   ((pRti)->opAborted)
+#define CAEPU_RT_ABORT(pRti)        ((pRti)->opAborted = PWP_TRUE)
+
+PWP_BOOL caeuProgressInit(CAEP_RTITEM *pRti, PWP_UINT32 cnt);
+PWP_BOOL caeuProgressBeginStep(CAEP_RTITEM *pRti, PWP_UINT32 total);
+PWP_BOOL caeuProgressIncr(CAEP_RTITEM *pRti);
+PWP_BOOL caeuProgressEndStep(CAEP_RTITEM *pRti);
+PWP_VOID caeuProgressEnd(CAEP_RTITEM *pRti, PWP_BOOL ok);
+
+PWP_VOID caeuSendDebugMsg(CAEP_RTITEM *pRti, const char *txt, PWP_UINT32 code);
+PWP_VOID caeuSendInfoMsg(CAEP_RTITEM *pRti, const char *txt, PWP_UINT32 code);
+PWP_VOID caeuSendWarningMsg(CAEP_RTITEM *pRti, const char *txt,
+            PWP_UINT32 code);
+PWP_VOID caeuSendErrorMsg(CAEP_RTITEM *pRti, const char *txt, PWP_UINT32 code);
+
+PWP_BOOL caeuAssignInfoValue(const char *key, const char *value,
+            bool createIfNotExists);
+PWP_BOOL caeuPublishValueDefinition(const char *key, PWP_ENUM_VALTYPE type,
+            const char *value, const char *access, const char *desc,
+            const char *range);
+
+#endif /* _APICAEPUTILS_H_ */
+
+/****************************************************************************
+ *
+ * This file is licensed under the Cadence Public License Version 1.0 (the
+ * "License"), a copy of which is found in the included file named "LICENSE",
+ * and is distributed "AS IS." TO THE MAXIMUM EXTENT PERMITTED BY APPLICABLE
+ * LAW, CADENCE DISCLAIMS ALL WARRANTIES AND IN NO EVENT SHALL BE LIABLE TO
+ * ANY PARTY FOR ANY DAMAGES ARISING OUT OF OR RELATING TO USE OF THIS FILE.
+ * Please see the License for the full text of applicable terms.
+ *
+ ****************************************************************************/
@@ -0,0 +1,194 @@
+/****************************************************************************
+ *
+ * (C) 2021 Cadence Design Systems, Inc. All rights reserved worldwide.
+ *
+ * This sample source code is not supported by Cadence Design Systems, Inc.
+ * It is provided freely for demonstration purposes only.
+ * SEE THE WARRANTY DISCLAIMER AT THE BOTTOM OF THIS FILE.
+ *
+ ***************************************************************************/
+/****************************************************************************
+ *
+ * Pointwise Grid Model API (PWGM-API)
+ *
+ * Benchmark stand-in for the PluginSDK header of the same name. Declares
+ * only what runtimeWrite.cxx uses, with the same names and signatures.
+ *
+ ***************************************************************************/
+
+#ifndef _APIGRIDMODEL_H_
+#define _APIGRIDMODEL_H_
+
+#include "apiPWP.h"
+
+// The stand-in model object. See GridModelStandIn.h.
+struct PWGM_HGRIDMODEL_t;
+typedef struct PWGM_HGRIDMODEL_t *PWGM_HGRIDMODEL;
+
+// Entity handles: the owning model and an index
+typedef struct PWGM_HENTITY_t {
+    PWGM_HGRIDMODEL hP;
+    PWP_UINT32      id;
+} PWGM_HBLOCK, PWGM_HDOMAIN, PWGM_HVERTEX;
+
+// Element handle: the owning model, the parent type (0 = model or block,
+// 1 = domain), the parent index and the element index
+typedef struct PWGM_HELEMENT_t {
+    PWGM_HGRIDMODEL hP;
+    PWP_UINT32      ptype;
+    PWP_UINT32      pid;
+    PWP_UINT32      id;
+} PWGM_HELEMENT;
+
+#define PWGM_HBLOCK_ISVALID(h)      (0 != (h).hP)
+#define PWGM_HDOMAIN_ISVALID(h)     (0 != (h).hP)
+#define PWGM_HVERTEX_ISVALID(h)     (0 != (h).hP)
+#define PWGM_HELEMENT_ISVALID(h)    (0 != (h).hP)
+#define PWGM_HBLOCK_ID(h)           ((h).id)
+#define PWGM_HDOMAIN_ID(h)          ((h).id)
+#define PWGM_HVERTEX_ID(h)          ((h).id)
+#define PWGM_HELEMENT_ID(h)         ((h).id)
+#define PWGM_HELEMENT_PID(h)        ((h).pid)
+
+typedef PWP_REAL PWGM_XYZVAL;
+
+typedef struct PWGM_VERTDATA_t {
+    PWGM_XYZVAL x;
+    PWGM_XYZVAL y;
+    PWGM_XYZVAL z;
+    PWP_UINT32  i;
+} PWGM_VERTDATA;
+
+typedef enum PWGM_ENUM_ELEMTYPE_e {
+    PWGM_ELEMTYPE_BAR,
+    PWGM_ELEMTYPE_HEX,
+    PWGM_ELEMTYPE_QUAD,
+    PWGM_ELEMTYPE_TRI,
+    PWGM_ELEMTYPE_TET,
+    PWGM_ELEMTYPE_WEDGE,
+    PWGM_ELEMTYPE_PYRAMID,
+    PWGM_ELEMTYPE_POINT,
+    PWGM_ELEMTYPE_SIZE
+} PWGM_ENUM_ELEMTYPE;
+
+#define PWGM_ELEMDATA_VERT_SIZE 8
+
+typedef struct PWGM_ELEMDATA_t {
+    PWGM_ENUM_ELEMTYPE  type;
+    PWP_UINT32          vertCnt;
+    PWGM_HVERTEX        vert[PWGM_ELEMDATA_VERT_SIZE];
+    PWP_UINT32          index[PWGM_ELEMDATA_VERT_SIZE];
+} PWGM_ELEMDATA;
+
+typedef struct PWGM_ELEMCOUNTS_t {
+    PWP_UINT32 count[PWGM_ELEMTYPE_SIZE];
+} PWGM_ELEMCOUNTS;
+
+typedef struct PWGM_CONDDATA_t {
+    const char *name;
+    PWP_UINT32  id;
+    const char *type;
+    PWP_UINT32  tid;
+} PWGM_CONDDATA;
+
+typedef enum PWGM_ENUM_FACEORDER_e {
+    PWGM_FACEORDER_DONTCARE,
+    PWGM_FACEORDER_BOUNDARYFIRST,
+    PWGM_FACEORDER_BOUNDARYLAST,
+    PWGM_FACEORDER_INTERIORONLY,
+    PWGM_FACEORDER_BOUNDARYONLY,
+    PWGM_FACEORDER_BCGROUPSFIRST,
+    PWGM_FACEORDER_BCGROUPSLAST,
+    PWGM_FACEORDER_BCGROUPSONLY,
+    PWGM_FACEORDER_SIZE
+} PWGM_ENUM_FACEORDER;
+
+typedef enum PWGM_ENUM_FACETYPE_e {
+    PWGM_FACETYPE_BOUNDARY,
+    PWGM_FACETYPE_INTERIOR,
+    PWGM_FACETYPE_CONNECTION,
+    PWGM_FACETYPE_SIZE
+} PWGM_ENUM_FACETYPE;
+
+typedef struct PWGM_FACEREF_DATA_t {
+    PWGM_HELEMENT   blockElem;
+    PWP_UINT32      cellIndex;
+    PWP_UINT32      cellFaceIndex;
+    PWGM_HDOMAIN    domain;
+    PWGM_HELEMENT   domainElem;
+    PWP_UINT32      domainElemIndex;
+} PWGM_FACEREF_DATA;
+
+typedef struct PWGM_BEGINSTREAM_DATA_t {
+    PWP_UINT32  totalNumFaces;
+    PWP_UINT32  numInteriorFaces;
+    PWP_UINT32  numBoundaryFaces;
+    PWP_UINT32  numConnections;
+    PWP_UINT32  numBcFaces;
+    void *      userData;
+} PWGM_BEGINSTREAM_DATA;
+
+typedef struct PWGM_FACESTREAM_DATA_t {
+    PWP_UINT32          face;
+    PWGM_ELEMDATA       elemData;
+    PWGM_ENUM_FACETYPE  type;
+    PWGM_FACEREF_DATA   owner;
+    PWP_UINT32          neighborCellIndex;
+    void *              userData;
+} PWGM_FACESTREAM_DATA;
+
+typedef struct PWGM_ENDSTREAM_DATA_t {
+    PWP_BOOL    ok;
+    void *      userData;
+} PWGM_ENDSTREAM_DATA;
+
+typedef PWP_UINT32 (*PWGM_BEGINSTREAMCB)(PWGM_BEGINSTREAM_DATA *data);
+typedef PWP_UINT32 (*PWGM_FACESTREAMCB)(PWGM_FACESTREAM_DATA *data);
+typedef PWP_UINT32 (*PWGM_ENDSTREAMCB)(PWGM_ENDSTREAM_DATA *data);
+
+PWP_UINT32      PwModBlockCount(PWGM_HGRIDMODEL model);
+PWGM_HBLOCK     PwModEnumBlocks(PWGM_HGRIDMODEL model, PWP_UINT32 ndx);
+PWP_UINT32      PwModDomainCount(PWGM_HGRIDMODEL model);
+PWGM_HDOMAIN    PwModEnumDomains(PWGM_HGRIDMODEL model, PWP_UINT32 ndx);
+PWP_UINT32      PwModVertexCount(PWGM_HGRIDMODEL model);
+PWGM_HVERTEX    PwModEnumVertices(PWGM_HGRIDMODEL model, PWP_UINT32 ndx);
+PWP_UINT32      PwModEnumElementCount(PWGM_HGRIDMODEL model,
+                    PWGM_ELEMCOUNTS *pCounts);
+PWGM_HELEMENT   PwModEnumElements(PWGM_HGRIDMODEL model, PWP_UINT32 ndx);
+PWP_BOOL        PwModStreamFaces(PWGM_HGRIDMODEL model,
+                    PWGM_ENUM_FACEORDER order, PWGM_BEGINSTREAMCB beginCB,
+                    PWGM_FACESTREAMCB faceCB, PWGM_ENDSTREAMCB endCB,
+                    void *userData);
+PWP_BOOL        PwModGetAttributeString(PWGM_HGRIDMODEL model,
+                    const char *name, const char **val);
+PWP_BOOL        PwModGetAttributeUINT32(PWGM_HGRIDMODEL model,
+                    const char *name, PWP_UINT32 *val);
+PWP_BOOL        PwModGetAttributeBOOL(PWGM_HGRIDMODEL model,
+                    const char *name, PWP_BOOL *val);
+PWP_BOOL        PwModGetAttributeEnum(PWGM_HGRIDMODEL model,
+                    const char *name, const char **val);
+
+PWP_UINT32      PwBlkElementCount(PWGM_HBLOCK block, PWGM_ELEMCOUNTS *pCounts);
+PWGM_HELEMENT   PwBlkEnumElements(PWGM_HBLOCK block, PWP_UINT32 ndx);
+PWP_BOOL        PwBlkCondition(PWGM_HBLOCK block, PWGM_CONDDATA *pCondData);
+
+PWP_UINT32      PwDomElementCount(PWGM_HDOMAIN domain,
+                    PWGM_ELEMCOUNTS *pCounts);
+PWGM_HELEMENT   PwDomEnumElements(PWGM_HDOMAIN domain, PWP_UINT32 ndx);
+PWP_BOOL        PwDomCondition(PWGM_HDOMAIN domain, PWGM_CONDDATA *pCondData);
+
+PWP_BOOL        PwVertDataMod(PWGM_HVERTEX vertex, PWGM_VERTDATA *pVertData);
+PWP_BOOL        PwElemDataMod(PWGM_HELEMENT element, PWGM_ELEMDATA *pElemData);
+
+#endif /* _APIGRIDMODEL_H_ */
+
+/****************************************************************************
+ *
+ * This file is licensed under the Cadence Public License Version 1.0 (the
+ * "License"), a copy of which is found in the included file named "LICENSE",
+ * and is distributed "AS IS." TO THE MAXIMUM EXTENT PERMITTED BY APPLICABLE
+ * LAW, CADENCE DISCLAIMS ALL WARRANTIES AND IN NO EVENT SHALL BE LIABLE TO
+ * ANY PARTY FOR ANY DAMAGES ARISING OUT OF OR RELATING TO USE OF THIS FILE.
+ * Please see the License for the full text of applicable terms.
+ *
+ ****************************************************************************/
@@ -0,0 +1,86 @@
+/****************************************************************************
+ *
+ * (C) 2021 Cadence Design Systems, Inc. All rights reserved worldwide.
+ *
+ * This sample source code is not supported by Cadence Design Systems, Inc.
+ * It is provided freely for demonstration purposes only.
+ * SEE THE WARRANTY DISCLAIMER AT THE BOTTOM OF THIS FILE.
+ *
+ ***************************************************************************/
+/****************************************************************************
+ *
+ * Pointwise Plugin API (PWP-API) base types
+ *
+ * Benchmark stand-in for the PluginSDK header of the same name. Declares
+ * only what runtimeWrite.cxx uses, with the same names and signatures.
+ *
+ ***************************************************************************/
+
+#ifndef _APIPWP_H_
+#define _APIPWP_H_
+
+#include <stddef.h>
+#include <stdio.h>
+#include <time.h>
+
+typedef unsigned int        PWP_UINT32;
+typedef int                 PWP_INT32;
+typedef unsigned long long  PWP_UINT64;
+typedef long long           PWP_INT64;
+typedef unsigned char       PWP_UINT8;
+typedef unsigned int        PWP_UINT;
+typedef int                 PWP_INT;
+typedef int                 PWP_BOOL;
+typedef void                PWP_VOID;
+typedef double              PWP_REAL;
+typedef float               PWP_FLOAT;
+
+#define PWP_TRUE        1
+#define PWP_FALSE       0
+#define PWP_UINT32_MAX  0xFFFFFFFFU
+
+#if !defined(ARRAYSIZE)
+#   define ARRAYSIZE(arrname)   (sizeof(arrname) / sizeof(arrname[0]))
+#endif
+
+typedef enum PWP_ENUM_ENCODING_e {
+    PWP_ENCODING_ASCII,
+    PWP_ENCODING_BINARY,
+    PWP_ENCODING_UNFORMATTED,
+    PWP_ENCODING_SIZE
+} PWP_ENUM_ENCODING;
+
+typedef enum PWP_ENUM_PRECISION_e {
+    PWP_PRECISION_SINGLE,
+    PWP_PRECISION_DOUBLE,
+    PWP_PRECISION_SIZE
+} PWP_ENUM_PRECISION;
+
+typedef enum PWP_ENUM_DIMENSION_e {
+    PWP_DIMENSION_2D,
+    PWP_DIMENSION_3D,
+    PWP_DIMENSION_SIZE
+} PWP_ENUM_DIMENSION;
+
+typedef enum PWP_ENUM_VALTYPE_e {
+    PWP_VALTYPE_STRING,
+    PWP_VALTYPE_INT,
+    PWP_VALTYPE_UINT,
+    PWP_VALTYPE_REAL,
+    PWP_VALTYPE_ENUM,
+    PWP_VALTYPE_BOOL,
+    PWP_VALTYPE_SIZE
+} PWP_ENUM_VALTYPE;
+
+#endif /* _APIPWP_H_ */
+
+/****************************************************************************
+ *
+ * This file is licensed under the Cadence Public License Version 1.0 (the
+ * "License"), a copy of which is found in the included file named "LICENSE",
+ * and is distributed "AS IS." TO THE MAXIMUM EXTENT PERMITTED BY APPLICABLE
+ * LAW, CADENCE DISCLAIMS ALL WARRANTIES AND IN NO EVENT SHALL BE LIABLE TO
+ * ANY PARTY FOR ANY DAMAGES ARISING OUT OF OR RELATING TO USE OF THIS FILE.
+ * Please see the License for the full text of applicable terms.
+ *
+ ****************************************************************************/
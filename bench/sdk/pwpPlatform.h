@@ -0,0 +1,50 @@
+/****************************************************************************
+ *
+ * (C) 2021 Cadence Design Systems, Inc. All rights reserved worldwide.
+ *
+ * This sample source code is not supported by Cadence Design Systems, Inc.
+ * It is provided freely for demonstration purposes only.
+ * SEE THE WARRANTY DISCLAIMER AT THE BOTTOM OF THIS FILE.
+ *
+ ***************************************************************************/
+/****************************************************************************
+ *
+ * Cross platform file functions
+ *
+ * Benchmark stand-in for the PluginSDK header of the same name. Declares
+ * only what runtimeWrite.cxx uses, with the same names and signatures.
+ *
+ ***************************************************************************/
+
+#ifndef _PWPPLATFORM_H_
+#define _PWPPLATFORM_H_
+
+#include <stdio.h>
+
+enum {
+    pwpRead         = 0x01,
+    pwpWrite        = 0x02,
+    pwpAppend       = 0x04,
+    pwpBinary       = 0x08,
+    pwpFormatted    = 0x10,
+    pwpUnformatted  = 0x20,
+    pwpAscii        = 0x40
+};
+
+FILE *  pwpFileOpen(const char *filename, int mode);
+int     pwpFileClose(FILE *fp);
+size_t  pwpFileWrite(const void *buf, size_t size, size_t count, FILE *fp);
+int     pwpFileDelete(const char *filename);
+
+#endif /* _PWPPLATFORM_H_ */
+
+/****************************************************************************
+ *
+ * This file is licensed under the Cadence Public License Version 1.0 (the
+ * "License"), a copy of which is found in the included file named "LICENSE",
+ * and is distributed "AS IS." TO THE MAXIMUM EXTENT PERMITTED BY APPLICABLE
+ * LAW, CADENCE DISCLAIMS ALL WARRANTIES AND IN NO EVENT SHALL BE LIABLE TO
+ * ANY PARTY FOR ANY DAMAGES ARISING OUT OF OR RELATING TO USE OF THIS FILE.
+ * Please see the License for the full text of applicable terms.
+ *
+ ****************************************************************************/
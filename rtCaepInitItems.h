@@ -43,7 +43,7 @@
         PWP_FALSE,               /* PWP_BOOL allowedFileFormatUnformatted */
 
         PWP_TRUE,               /* PWP_BOOL allowedDataPrecisionSingle */
-        PWP_FALSE,              /* PWP_BOOL allowedDataPrecisionDouble */
+        PWP_TRUE,               /* PWP_BOOL allowedDataPrecisionDouble */
 
         PWP_FALSE,              /* PWP_BOOL allowedDimension2D */
         PWP_TRUE                /* PWP_BOOL allowedDimension3D */
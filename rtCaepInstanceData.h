@@ -17,9 +17,11 @@
 #define _RTCAEPINSTANCEDATA_H_
 
 struct ADSData;
+class ADSWriteBuffer;
 
 // This macro is included in the CAEP_RTITEM structure declaration:
-#define CAEP_RUNTIME_INSTDATADECL   ADSData *adsData;
+#define CAEP_RUNTIME_INSTDATADECL   ADSData *adsData; \
+                                    ADSWriteBuffer *wrBuf;
 
 #endif /* _RTCAEPINSTANCEDATA_H_ */
 
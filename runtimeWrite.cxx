@@ -22,9 +22,28 @@
 #include "pwpPlatform.h"
 #include "string.h"
 
+#include "ADSCellOrder.h"
+#include "ADSFaceHash.h"
+#include "ADSFetch.h"
+#include "ADSGzipWriter.h"
+#include "ADSMappedFile.h"
+#include "ADSNumFormat.h"
+#include "ADSOrderedPipeline.h"
+#include "ADSPartition.h"
+#include "ADSProgress.h"
+#include "ADSRestManifest.h"
+#include "ADSRestReader.h"
+#include "ADSSimd.h"
+#include "ADSStageStats.h"
+#include "ADSVertexOrder.h"
+#include "ADSWriteBuffer.h"
+
+#include <algorithm>
+#include <atomic>
 #include <set>
 #include <sstream>
 #include <string>
+#include <thread>
 #include <vector>
 
 
@@ -55,6 +74,40 @@ const char * const BcNames[] = {
 const PWP_UINT32 NumBcs = ARRAYSIZE(BcNames) - 1;
 
 const char attrTitle[] = "Title";
+const char attrWriteBufferMB[] = "WriteBufferMB";
+const char attrWriterThreads[] = "WriterThreads";
+const char attrOutputMode[] = "OutputMode";
+const char attrStageStats[] = "StageStats";
+const char attrBcFaceEngine[] = "BcFaceEngine";
+const char attrCompression[] = "Compression";
+const char attrIncrementalExport[] = "IncrementalExport";
+const char attrModelRevision[] = "ModelRevision";
+const char attrAsyncWrite[] = "AsyncWrite";
+const char attrVertexOrder[] = "VertexOrder";
+const char attrCellOrder[] = "CellOrder";
+const char attrIndexWidth[] = "IndexWidth";
+const char attrPartitions[] = "Partitions";
+const char attrValidate[] = "Validate";
+
+// Largest count or 1-based index written as a 32-bit binary REST integer.
+// Kept to the signed range so readers that use signed 32-bit integers get the
+// same value.
+const PWP_UINT64 MaxIndex32 = 0x7FFFFFFF;
+
+// Largest count the grid model's 32-bit enumeration indices can address
+const PWP_UINT64 MaxModelCount = 0xFFFFFFFF;
+
+// Number of items converted by a writer thread in one chunk
+const PWP_UINT32 MTChunkSize = 32768;
+
+// Number of elements or vertices fetched from the grid model into one
+// ADSElemBatch or ADSVertexBatch before they are converted to records
+// together
+const PWP_UINT32 FetchBatch = 1024;
+
+// Number of items of a reusable REST section read from the grid model to
+// check that its grid data did not change
+const PWP_UINT32 GuardSamples = 64;
 
 
 static bool
@@ -77,13 +130,6 @@ GetBcData(PWGM_HDOMAIN dom, PWGM_CONDDATA &bc)
 }
 
 
-static bool
-GetBcData(CAEP_RTITEM &rti, PWP_UINT32 ndx, PWGM_CONDDATA &bc)
-{
-    return GetBcData(PwModEnumDomains(rti.model, ndx), bc);
-}
-
-
 /***************************************************************************/
 /***************************************************************************/
 /***************************************************************************/
@@ -98,12 +144,54 @@ private:
 
 public:
 
+    // Order of the REST connectivity records
+    enum CellOrder {
+        NativeCells,
+        MortonCells,
+        HilbertCells
+    };
+
+
     ADSData(CAEP_RTITEM &rti) :
         rti_(rti),
         prefix_(0),
+        bcTids_(),
+        bcIds_(),
+        bcNames_(),
         adsBcNames_(),
+        bcFaceCnts_(),
+        blkElemCnts_(),
+        blkVcTids_(),
+        blkElemTypes_(),
+        vertCnt_(0),
+        elemCnt_(0),
+        bcFaceCnt_(0),
+        cellTypes_(),
+        vertNewToOld_(),
+        vertOldToNew_(),
+        cellNewToOld_(),
+        cellOldToNew_(),
         usedPrefixPairs_(),
-        ndVar_(0)
+        ndVar_(0),
+        writeBufSize_(ADSWriteBuffer::DefaultSize),
+        writerThreads_(1),
+        mappedOutput_(false),
+        faceHashBc_(false),
+        gzipRest_(false),
+        incremental_(false),
+        revision_(),
+        asyncWrite_(true),
+        rcmOrder_(false),
+        cellOrder_(NativeCells),
+        wideIndices_(false),
+        partCnt_(1),
+        validate_(false),
+        manifest_(),
+        prevManifest_(),
+        prevRest_(0),
+        stats_(),
+        statsJson_(false),
+        progress_(rti)
     {
         rti_.adsData = this;
         memset(bcUsageCnt_, 0, sizeof(bcUsageCnt_));
@@ -113,6 +201,9 @@ public:
     {
     }
 
+    // Builds a summary of the grid model in one pass over its domains and
+    // blocks. The writers read the summary instead of querying the grid
+    // model again. Returns false if any domain's BC data is not available.
     bool init()
     {
         bool ret = true;
@@ -120,14 +211,26 @@ public:
         PWP_UINT32 domainCount = PwModDomainCount(rti_.model);
         PWP_UINT32 warnId = 0;
         PWGM_CONDDATA bc;
+        PWGM_ELEMCOUNTS eCounts;
         char adsBcName[80];
         prefix_.resize(domainCount, 0);
+        bcTids_.resize(domainCount);
+        bcIds_.resize(domainCount);
+        bcNames_.resize(domainCount);
         adsBcNames_.resize(domainCount);
+        bcFaceCnts_.resize(domainCount);
+        bcFaceCnt_ = 0;
         for (PWP_UINT32 i = 0; i < domainCount; ++i) {
-            if (!GetBcData(rti_, i, bc)) {
+            PWGM_HDOMAIN hDomain = PwModEnumDomains(rti_.model, i);
+            if (!GetBcData(hDomain, bc)) {
                 // bc is set to error values that are safe to use below
                 ret = false;
             }
+            bcTids_[i] = bc.tid;
+            bcIds_[i] = bc.id;
+            bcNames_[i] = bc.name;
+            bcFaceCnts_[i] = PwDomElementCount(hDomain, &eCounts);
+            bcFaceCnt_ += bcFaceCnts_[i];
             switch (bc.tid) {
             case 13: // fall through
             case 14: {
@@ -166,14 +269,13 @@ public:
         }
         // usedPrefixPairs_ is loaded, make sure 13/14 periodic BCs have a mate.
         for (PWP_UINT32 i = 0; i < domainCount; ++i) {
-            GetBcData(rti_, i, bc);
             PWP_UINT32 targetId = 0;
-            switch (bc.tid) {
+            switch (bcTids_[i]) {
             case 13:
-                targetId = 100 * bc.id + 14;
+                targetId = 100 * bcIds_[i] + 14;
                 break;
             case 14:
-                targetId = 100 * bc.id + 13;
+                targetId = 100 * bcIds_[i] + 13;
                 break;
             default:
                 continue;
@@ -181,20 +283,40 @@ public:
             if (usedPrefixPairs_.end() == usedPrefixPairs_.find(targetId)) {
                 // Could not find matching BC in pair!
                 std::ostringstream msg;
-                msg << "PERIODIC FACE '" << bc.name << "' (" << bc.tid << ":"
-                    << bc.id << ") does not have a match";
+                msg << "PERIODIC FACE '" << bcNames_[i] << "' (" << bcTids_[i]
+                    << ":" << bcIds_[i] << ") does not have a match";
                 caeuSendWarningMsg(&rti_, msg.str().c_str(), ++warnId);
             }
         }
 
-        // Determine the number of dependent variables; ndVar_
+        // Count the block elements and determine the number of dependent
+        // variables; ndVar_
         PWGM_CONDDATA condData;
         PWP_UINT32 ndx = 0;
         ndVar_ = 1;
         bool hasMixedVcTypes = false;
-        while(!rti_.opAborted && PwBlkCondition(PwModEnumBlocks(rti_.model,
-            ndx++), &condData)) {
-            if (0 == condData.tid) {
+        bool scanVcs = true;
+        blkElemCnts_.clear();
+        blkVcTids_.clear();
+        blkElemTypes_.clear();
+        elemCnt_ = 0;
+        PWGM_HBLOCK hBlock = PwModEnumBlocks(rti_.model, ndx);
+        while (PWGM_HBLOCK_ISVALID(hBlock)) {
+            blkElemCnts_.push_back(PwBlkElementCount(hBlock, &eCounts));
+            elemCnt_ += blkElemCnts_.back();
+            blkElemTypes_.push_back(PWGM_ELEMTYPE_SIZE);
+            for (int t = 0; t < PWGM_ELEMTYPE_SIZE; ++t) {
+                if (0 != eCounts.count[t] &&
+                        eCounts.count[t] == blkElemCnts_.back()) {
+                    blkElemTypes_.back() = PWP_UINT8(t);
+                }
+            }
+            // VCs are scanned up to the first block without one
+            scanVcs = scanVcs && !rti_.opAborted &&
+                PwBlkCondition(hBlock, &condData);
+            blkVcTids_.push_back(scanVcs ? condData.tid : 0);
+            hBlock = PwModEnumBlocks(rti_.model, ++ndx);
+            if (!scanVcs || 0 == condData.tid) {
                 // ignore Unsepcified VCs
             }
             else if (1 == ndx) {
@@ -209,6 +331,7 @@ public:
                 }
             }
         }
+        vertCnt_ = PwModVertexCount(rti_.model);
         if (hasMixedVcTypes) {
             caeuSendWarningMsg(&rti_, "This export contains mixed VC types!",
                 ++warnId);
@@ -217,7 +340,142 @@ public:
         if (0 != warnId) {
             caeuSendWarningMsg(&rti_, "done!", 0);
         }
-        return ret;
+
+        // Size of the REST file staging buffer
+        PWP_UINT32 bufMB;
+        if (PwModGetAttributeUINT32(rti_.model, attrWriteBufferMB, &bufMB) &&
+                (0 != bufMB)) {
+            writeBufSize_ = size_t(bufMB) * 1024 * 1024;
+        }
+
+        // Number of threads used to convert REST data. 0 means use all cores.
+        PWP_UINT32 threads;
+        if (PwModGetAttributeUINT32(rti_.model, attrWriterThreads, &threads)) {
+            if (0 == threads) {
+                threads = std::thread::hardware_concurrency();
+            }
+            writerThreads_ = (0 == threads) ? 1 : threads;
+        }
+
+        // Write the REST file through stdio or a memory mapping
+        const char *mode;
+        if (PwModGetAttributeEnum(rti_.model, attrOutputMode, &mode) &&
+                (0 == strcmp(mode, "Mapped"))) {
+            mappedOutput_ = (0 != CAEPU_RT_ENC_BINARY(&rti_));
+            if (!mappedOutput_) {
+                caeuSendInfoMsg(&rti_, "Mapped output requires binary "
+                    "encoding. Using buffered output.", 0);
+            }
+        }
+
+#if defined(ADS_USE_ZLIB)
+        // Compress the REST file as it is written
+        const char *compression;
+        if (PwModGetAttributeEnum(rti_.model, attrCompression, &compression)
+                && (0 == strcmp(compression, "Gzip"))) {
+            gzipRest_ = true;
+            if (mappedOutput_) {
+                mappedOutput_ = false;
+                caeuSendInfoMsg(&rti_, "Mapped output cannot be compressed. "
+                    "Using buffered output.", 0);
+            }
+        }
+#endif
+
+        // Reuse unchanged sections of the previous REST file. Only a sparse
+        // sample of the grid data is read to find the changes, so the caller
+        // must change the ModelRevision whenever the grid changes.
+        PWP_BOOL incremental;
+        if (PwModGetAttributeBOOL(rti_.model, attrIncrementalExport,
+                &incremental) && incremental) {
+            const char *revision = "";
+            PwModGetAttributeString(rti_.model, attrModelRevision, &revision);
+            revision_ = revision;
+            incremental_ = !mappedOutput_ && !gzipRest_ &&
+                (0 != CAEPU_RT_ENC_BINARY(&rti_));
+            if (!incremental_) {
+                caeuSendInfoMsg(&rti_, "Incremental export requires binary, "
+                    "buffered and uncompressed output. Writing all sections.",
+                    0);
+            }
+            else if (revision_.empty()) {
+                incremental_ = false;
+                caeuSendInfoMsg(&rti_, "Incremental export requires a "
+                    "ModelRevision. Writing all sections.", 0);
+            }
+        }
+
+        // Split the REST file into partition files
+        PWP_UINT32 partCnt;
+        if (PwModGetAttributeUINT32(rti_.model, attrPartitions, &partCnt) &&
+                (partCnt > 1)) {
+            // every partition gets at least one cell
+            partCnt_ = PWP_UINT32(std::min(PWP_UINT64(partCnt),
+                std::max(elemCnt_, PWP_UINT64(1))));
+            if (mappedOutput_ || gzipRest_ || incremental_) {
+                mappedOutput_ = false;
+                gzipRest_ = false;
+                incremental_ = false;
+                caeuSendInfoMsg(&rti_, "Partitioned export writes buffered, "
+                    "uncompressed REST files.", 0);
+            }
+        }
+
+        // Read the REST file back and check it against the model
+        PWP_BOOL validate;
+        if (PwModGetAttributeBOOL(rti_.model, attrValidate, &validate) &&
+                validate) {
+            validate_ = (0 != CAEPU_RT_ENC_BINARY(&rti_)) && !gzipRest_ &&
+                (1 == partCnt_);
+            if (!validate_) {
+                caeuSendInfoMsg(&rti_, "Validation requires a single binary, "
+                    "uncompressed REST file. Skipping it.", 0);
+            }
+        }
+
+        // Write the REST file chunks on a separate I/O thread
+        PWP_BOOL asyncWrite;
+        if (PwModGetAttributeBOOL(rti_.model, attrAsyncWrite, &asyncWrite)) {
+            asyncWrite_ = (0 != asyncWrite);
+        }
+
+        // Renumber the vertices for solver locality
+        const char *vertOrder;
+        if (PwModGetAttributeEnum(rti_.model, attrVertexOrder, &vertOrder)) {
+            rcmOrder_ = (0 == strcmp(vertOrder, "RCM"));
+        }
+
+        // Sort the cells along a space-filling curve of their centroids
+        const char *cellOrder;
+        if (PwModGetAttributeEnum(rti_.model, attrCellOrder, &cellOrder)) {
+            if (0 == strcmp(cellOrder, "Morton")) {
+                cellOrder_ = MortonCells;
+            }
+            else if (0 == strcmp(cellOrder, "Hilbert")) {
+                cellOrder_ = HilbertCells;
+            }
+        }
+
+        // Find the BC face owners with the face hash or PwModStreamFaces()
+        const char *bcEngine;
+        if (PwModGetAttributeEnum(rti_.model, attrBcFaceEngine, &bcEngine)) {
+            faceHashBc_ = (0 == strcmp(bcEngine, "FaceHash"));
+        }
+
+        // Per-stage timing and counts
+        const char *statsMode;
+        if (PwModGetAttributeEnum(rti_.model, attrStageStats, &statsMode)) {
+            statsJson_ = (0 == strcmp(statsMode, "Json"));
+            stats_.enable(statsJson_ || (0 == strcmp(statsMode, "Messages")));
+        }
+
+        // Width of the binary REST integers
+        const char *indexWidth;
+        if (PwModGetAttributeEnum(rti_.model, attrIndexWidth, &indexWidth)) {
+            wideIndices_ = (0 == strcmp(indexWidth, "64bit"));
+        }
+        return checkCount("NNL", vertCnt_) && checkCount("NEL", elemCnt_) &&
+            checkCount("NBCL", bcFaceCnt_) && ret;
     }
 
 
@@ -243,497 +501,3281 @@ public:
     }
 
 
-private:
+    inline PWP_UINT32 getBcCount() const
+    {
+        return PWP_UINT32(bcNames_.size());
+    }
 
-    // Runtime information
-    CAEP_RTITEM &rti_;
 
-    // Global sequence id assigned to each boundary domain. There is one item
-    // for each boundary domain in the grid model.
-    UINT32Vec   prefix_;
+    inline PWP_UINT32 getBlockCount() const
+    {
+        return PWP_UINT32(blkElemCnts_.size());
+    }
 
-    // Number of times each BC is used in grid model. There is one item for
-    // each BC type supported (plus one error item).
-    PWP_UINT32  bcUsageCnt_[NumBcs + 1];
 
-    // BC names formatted for ADS: "<NN>_<AdsBcTypeName>". Where, NN is the
-    // usage count for <AdsBcTypeName>.
-    StringVec   adsBcNames_;
+    inline PWP_UINT32 getBlockElementCount(PWP_UINT32 ndx) const
+    {
+        return blkElemCnts_.at(ndx);
+    }
 
-    // Set of already used prefix_ values for paired BC types 13 and 14.
-    // Duplicate id usage generates a warning.
-    UINT32Set   usedPrefixPairs_;
 
-    // Number of dependent variables
-    PWP_UINT32  ndVar_;
-};
+    inline PWP_UINT32 getBlockVcTid(PWP_UINT32 ndx) const
+    {
+        return blkVcTids_.at(ndx);
+    }
 
 
-static void
-closeFile(CAEP_RTITEM &rti)
-{
-    if (0 != rti.fp) {
-        pwpFileClose(rti.fp);
-        rti.fp = 0;
+    // Gets the type of every element of block ndx. Returns false if the
+    // block has more than one element type or no elements.
+    inline bool getBlockElementType(PWP_UINT32 ndx,
+        PWGM_ENUM_ELEMTYPE &type) const
+    {
+        if (PWGM_ELEMTYPE_SIZE == blkElemTypes_.at(ndx)) {
+            return false;
+        }
+        type = PWGM_ENUM_ELEMTYPE(blkElemTypes_.at(ndx));
+        return true;
     }
-}
 
 
-static bool
-openFile(CAEP_RTITEM &rti, const char *ext, PWP_ENUM_ENCODING encoding)
-{
-    closeFile(rti);
-    std::string fname(rti.pWriteInfo->fileDest);
-    if (ext && ext[0]) {
-        fname += ".";
-        fname += ext;
-    }
-    int mode = pwpWrite;
-    if (PWP_ENCODING_BINARY == encoding) {
-        mode |= pwpBinary;
-    }
-    else {
-        mode |= pwpAscii;
+    inline PWP_UINT32 getBoundaryFaceCount(PWP_UINT32 ndx) const
+    {
+        return bcFaceCnts_.at(ndx);
     }
-    rti.fp = pwpFileOpen(fname.c_str(), mode);
-    return 0 != rti.fp;
-}
 
 
-static bool
-writeTitle(CAEP_RTITEM &rti)
-{
-    // get the title from set attribute -> title
-    const char* title;
-    PwModGetAttributeString(rti.model, attrTitle, &title);
-    if (CAEPU_RT_ENC_BINARY(&rti)) {
-        // Write left-justified, 80 character, space-padded string
-        fprintf(rti.fp, "%-80.80s", title);
-    }
-    else {
-        fprintf(rti.fp, "%s\n\n", title);
+    inline PWP_UINT32 getVertexCount() const
+    {
+        return PWP_UINT32(vertCnt_);
     }
-    return true;
-}
 
 
-static inline void
-writeArray(CAEP_RTITEM &rti, PWP_UINT32 *var, PWP_UINT32 count, int fldWd = 1)
-{
-    if (CAEPU_RT_ENC_BINARY(&rti)) {
-        fwrite(var, sizeof(PWP_UINT32), count, rti.fp);
-    }
-    else {
-        PWP_UINT32 i;
-        for (i = 0; i < count - 1; ++i) {
-            fprintf(rti.fp, "%*lu ", fldWd, (unsigned long)var[i]);
-        }
-        // write last value with newline
-        fprintf(rti.fp, "%*lu\n", fldWd, (unsigned long)var[i]);
+    // Number of volume elements in all blocks; NEL. init() fails if the
+    // total does not fit.
+    inline PWP_UINT32 getElementCount() const
+    {
+        return PWP_UINT32(elemCnt_);
     }
-}
 
 
-static inline void
-writeArray(CAEP_RTITEM &rti, float *var, PWP_UINT32 count)
-{
-    if (CAEPU_RT_ENC_BINARY(&rti)) {
-        fwrite(var, sizeof(float), count, rti.fp);
-    }
-    else {
-        PWP_UINT32 i;
-        for (i = 0; i < count - 1; ++i) {
-            fprintf(rti.fp, "%9f ", var[i]);
-        }
-        // write last value with newline
-        fprintf(rti.fp, "%9f\n", var[i]);
+    // Number of boundary faces in all domains; NBCL. init() fails if the
+    // total does not fit.
+    inline PWP_UINT32 getBoundaryFaceCount() const
+    {
+        return PWP_UINT32(bcFaceCnt_);
     }
-}
 
 
-static bool
-writeZeroLine(CAEP_RTITEM &rti)
-{
-    const PWP_UINT32 VARSZ = 15;
-    // init var[] to all zeros
-    PWP_UINT32 var[VARSZ] = { 0 };
-    writeArray(rti, var, VARSZ);
-    return true;
-}
+    // Sizes the cell type cache for all elements. Each entry is unknown
+    // until setCellType() is called.
+    void initCellTypes()
+    {
+        cellTypes_.assign(elemCnt_, PWP_UINT8(PWGM_ELEMTYPE_SIZE));
+    }
 
 
-static PWP_UINT32
-countElements(CAEP_RTITEM &rti) // NEL
-{
-    PWP_UINT32 eTot = 0; // total element count
-    PWGM_ELEMCOUNTS eCounts; // element count bin
-    PWP_UINT32 ndx = 0; // block index
-    PWGM_HBLOCK hBlock = PwModEnumBlocks(rti.model, ndx); // block handle
-    while (PWGM_HBLOCK_ISVALID(hBlock)) {
-        eTot += PwBlkElementCount(hBlock, &eCounts);
-        hBlock = PwModEnumBlocks(rti.model, ++ndx);
+    // Caches the type of the element with model index ndx. Different
+    // threads may set different elements at the same time.
+    inline void setCellType(PWP_UINT32 ndx, PWGM_ENUM_ELEMTYPE type)
+    {
+        cellTypes_[ndx] = PWP_UINT8(type);
     }
-    return eTot;
-}
 
 
-static PWP_UINT32
-countBoundaryFaces(CAEP_RTITEM &rti) // NBCL
-{
-    PWP_UINT32 eTot = 0;
-    PWGM_ELEMCOUNTS eCounts;
-    PWP_UINT32 iDomain = 0;
-    PWGM_HDOMAIN hDomain = PwModEnumDomains(rti.model, iDomain);
-    while (PWGM_HDOMAIN_ISVALID(hDomain)) {
-        eTot += PwDomElementCount(hDomain,&eCounts);
-        hDomain = PwModEnumDomains(rti.model,++iDomain);
+    // Caches type as the type of count elements starting at model index
+    // first
+    inline void setCellTypes(PWP_UINT32 first, PWP_UINT32 count,
+        PWGM_ENUM_ELEMTYPE type)
+    {
+        std::fill(cellTypes_.begin() + first,
+            cellTypes_.begin() + first + count, PWP_UINT8(type));
     }
-    return eTot;
-}
 
 
-static bool
-writeFirstLine(CAEP_RTITEM &rti)
-{
-    // nsector,nisbc,ndvar,imesh,niter,itime,inrit,units,nitsc,nbk,5xIDM
-    const PWP_UINT32 VARSZ = 15;
-    // init var[] to all zeros
-    PWP_UINT32 var[VARSZ] = { 0 };
-    // set values accordingly
-    var[0] = 1; // NSECTIONS
-    var[2] = rti.adsData->getNDVAR(); // NDVAR
-    var[6] = PwModBlockCount(rti.model); // NBK
-    writeArray(rti, var, VARSZ);
-    return true;
-}
-
+    // Gets the cached type of the element with model index ndx. Returns
+    // false if it is not cached.
+    inline bool getCellType(PWP_UINT32 ndx, PWGM_ENUM_ELEMTYPE &type) const
+    {
+        if (ndx >= cellTypes_.size() ||
+                PWGM_ELEMTYPE_SIZE == cellTypes_[ndx]) {
+            return false;
+        }
+        type = PWGM_ENUM_ELEMTYPE(cellTypes_[ndx]);
+        return true;
+    }
 
-static bool
-writeSecondLine(CAEP_RTITEM &rti)
-{
-    // rinpax,uinpav,gc,gal,dtin,tmacc,9xIDM
-    return writeZeroLine(rti);
-}
 
+    // Sets the REST vertex order. newToOld[i] is the model index of the
+    // vertex written at REST position i.
+    void setVertexOrder(UINT32Vec &newToOld)
+    {
+        vertNewToOld_.swap(newToOld);
+        vertOldToNew_.resize(vertNewToOld_.size());
+        for (PWP_UINT32 i = 0; i < PWP_UINT32(vertNewToOld_.size()); ++i) {
+            vertOldToNew_[vertNewToOld_[i]] = i;
+        }
+    }
 
-static bool
-writeThirdLine(CAEP_RTITEM &rti)
-{
-    // nnl,nel,nbcl,ngrid,ncdut,nsfl,bksl,8xIDM
-    const PWP_UINT32 VARSZ = 15;
-    // init var[] to all zeros
-    PWP_UINT32 var[VARSZ] = { 0 };
-    // set values accordingly
-    var[0] = PwModVertexCount(rti.model); // NNL
-    var[1] = countElements(rti); // NEL
-    var[2] = countBoundaryFaces(rti); // NBCL
-    var[4] = rti.adsData->getNDVAR(); // NCDUT
-    writeArray(rti, var, VARSZ);
-    return true;
-}
 
+    // Model index of the vertex written at REST position ndx. The order is
+    // the model's order if no vertex order is set.
+    inline PWP_UINT32 modelVertex(PWP_UINT32 ndx) const
+    {
+        return (ndx < vertNewToOld_.size()) ? vertNewToOld_[ndx] : ndx;
+    }
 
-static bool
-writeFourthLine(CAEP_RTITEM &rti)
-{
-    // rpms,pgaug,egaug,fvs,sfrl,twal,pnll,pntl,tfree,lfree,5xIDM
-    return writeZeroLine(rti);
-}
 
+    // REST position of the vertex with model index ndx
+    inline PWP_UINT32 restVertex(PWP_UINT32 ndx) const
+    {
+        return (ndx < vertOldToNew_.size()) ? vertOldToNew_[ndx] : ndx;
+    }
 
-static bool
-writeVertices(CAEP_RTITEM &rti)
-{
-    const PWP_UINT32 VARSZ = 15;
-    const float DVAR = 0.0;
-    const float PSND = 0.0;
 
-    bool ret = false;
-    PWP_UINT32 NVAR = rti.adsData->getNDVAR();
-    // Array bounds check. Use >= to allow for PSND value
-    if (NVAR >= VARSZ) {
-        CAEPU_RT_ABORT(&rti);
+    // Sets the record at ndx to the 1-based REST vertex indices of eData.
+    // See adsRebaseIndices().
+    inline void restIndices(const PWGM_ELEMDATA &eData, PWP_UINT32 *ndx) const
+    {
+        const PWP_UINT32 pos = 0;
+        adsRebaseIndices(eData.index, eData.vertCnt, &pos, 1,
+            vertOldToNew_.data(), vertOldToNew_.size(), ndx);
     }
-    else {
-        // Number of floats to write for each vertex == xyz + dep var count
-        PWP_UINT32 count = 3 + NVAR;
-
-        // init var[] to all zeros. +3 to allow for XYZ. The values after XYZ
-        // don't change. Set them once up front.
-        float var[3 + VARSZ] = { 0.0 };
-        for (PWP_UINT32 i = 3; i < count; ++i) {
-            var[i] = DVAR;
-        }
-
-        if (1 != NVAR) {
-            // post-incr count so PSND gets written too
-            var[count++] = PSND;
-        }
-
-        if (caeuProgressBeginStep(&rti, PwModVertexCount(rti.model))) {
-            ret = true;
-            PWGM_VERTDATA v;
-            PWP_UINT32 vNdx = 0;
-            while (PwVertDataMod(PwModEnumVertices(rti.model, vNdx++), &v)) {
-                // update XYZ values
-                var[0] = float(v.x);
-                var[1] = float(v.y);
-                var[2] = float(v.z);
-                writeArray(rti, var, count);
-                if (!caeuProgressIncr(&rti)) {
-                    ret = false;
-                    break;
-                }
+
+
+    // Sets the records at ndx to the 1-based REST vertex indices of the
+    // cells in batch. Each type group is converted in one kernel call.
+    void restIndices(const ADSElemBatch &batch, PWP_UINT32 *ndx) const
+    {
+        for (int t = 0; t < PWGM_ELEMTYPE_SIZE; ++t) {
+            const ADSElemBatch::Group &g = batch.group(t);
+            if (0 != g.count) {
+                adsRebaseIndices(g.index, g.vertCnt, g.pos, g.count,
+                    vertOldToNew_.data(), vertOldToNew_.size(), ndx);
             }
         }
-        caeuProgressEndStep(&rti);
     }
-    return ret;
-}
 
 
-static bool
-writeConnectivity(CAEP_RTITEM &rti)
-{
-    bool ret = false;
-    PWP_UINT32 elemCnt = PwModEnumElementCount(rti.model, 0);
-    if (caeuProgressBeginStep(&rti, elemCnt)) {
-        ret = true;
-        PWP_UINT32 j;
-        PWP_UINT32 ndx[PWGM_ELEMDATA_VERT_SIZE];
-        PWGM_ELEMDATA eData;
-        PWP_UINT32 eNdx = 0;
-        // iterate over all elements
-        while (PwElemDataMod(PwModEnumElements(rti.model, eNdx++), &eData)) {
-            for (j = 0; j < eData.vertCnt; ++j) {
-                // ADS uses 1-based indices
-                ndx[j] = eData.index[j] + 1;
-            }
-            // repeat last index to fill out all PWGM_ELEMDATA_VERT_SIZE values
-            for (; j < PWGM_ELEMDATA_VERT_SIZE; ++j) {
-                ndx[j] = ndx[eData.vertCnt - 1];
-            }
-            writeArray(rti, ndx, PWGM_ELEMDATA_VERT_SIZE, 5);
-            if (!caeuProgressIncr(&rti)) {
-                ret = false;
-                break;
-            }
+    // Sets the REST cell order. newToOld[i] is the model index of the cell
+    // written at REST position i.
+    void setCellOrder(UINT32Vec &newToOld)
+    {
+        cellNewToOld_.swap(newToOld);
+        cellOldToNew_.resize(cellNewToOld_.size());
+        for (PWP_UINT32 i = 0; i < PWP_UINT32(cellNewToOld_.size()); ++i) {
+            cellOldToNew_[cellNewToOld_[i]] = i;
         }
     }
-    caeuProgressEndStep(&rti);
-    return ret;
-}
 
 
-static PWP_UINT32
-fixFace(PWGM_ENUM_ELEMTYPE eType, PWP_UINT32 pwFaceNdx)
-{
-    const PWP_UINT32 badIndex = 9999;
-    PWP_UINT32 adsFaceNdx;
-    switch (eType) {
-    case PWGM_ELEMTYPE_TET: {
-        static const PWP_UINT32 tetMap[] = { 4, 3, 1, 2, badIndex };
-        adsFaceNdx = tetMap[pwFaceNdx < 4 ? pwFaceNdx : 4];
-        break; }
-    case PWGM_ELEMTYPE_HEX: {
-        static const PWP_UINT32 hexMap[] = { 5, 6, 3, 2, 4, 1, badIndex };
-        adsFaceNdx = hexMap[pwFaceNdx < 6 ? pwFaceNdx : 6];
-        break; }
-    case PWGM_ELEMTYPE_WEDGE: {
-        static const PWP_UINT32 wedgeMap[] = { 5, 1, 3, 4, 2, badIndex };
-        adsFaceNdx = wedgeMap[pwFaceNdx < 5 ? pwFaceNdx : 5];
-        break; }
-    case PWGM_ELEMTYPE_PYRAMID:
-        adsFaceNdx = pwFaceNdx + 1;
-        break;
-    default:
-        adsFaceNdx = badIndex;
-        break;
+    // Model index of the cell written at REST position ndx. The order is
+    // the model's order if no cell order is set.
+    inline PWP_UINT32 modelCell(PWP_UINT32 ndx) const
+    {
+        return (ndx < cellNewToOld_.size()) ? cellNewToOld_[ndx] : ndx;
     }
-    return adsFaceNdx;
-}
 
 
-PWP_UINT32 beginCB(PWGM_BEGINSTREAM_DATA *data)
-{
-    // set starting progress step count
-    CAEP_RTITEM *pRti = (CAEP_RTITEM*)data->userData;
-    return caeuProgressBeginStep(pRti, data->totalNumFaces);
-}
+    // REST position of the cell with model index ndx
+    inline PWP_UINT32 restCell(PWP_UINT32 ndx) const
+    {
+        return (ndx < cellOldToNew_.size()) ? cellOldToNew_[ndx] : ndx;
+    }
 
 
-PWP_UINT32 faceCB(PWGM_FACESTREAM_DATA *data)
-{
-    PWP_UINT32 ret = 0;
-    PWGM_ELEMDATA faceElemData;
-    if (PwElemDataMod(data->owner.blockElem, &faceElemData)) {
-        CAEP_RTITEM &rti = *((CAEP_RTITEM*)data->userData);
-        PWP_UINT32 var[3];
-        // The cell's index in the model's index space (1..totalNumCells)
-        var[0] = data->owner.cellIndex + 1; // cellID
-        // Convert from PW local face id to ADS local face id
-        var[1] = fixFace(faceElemData.type, data->owner.cellFaceIndex);
-        // Get the domains ADS type id
-        var[2] = rti.adsData->getCDtid(data->owner.domain);
-        writeArray(rti, var, 3);
-        ret = caeuProgressIncr(&rti);
+    inline const char *getBcName(PWP_UINT32 ndx) const
+    {
+        return bcNames_.at(ndx).c_str();
     }
-    return ret;
-}
-
 
-PWP_UINT32 endCB(PWGM_ENDSTREAM_DATA *data)
-{
-    // end progress step
-    return caeuProgressEndStep((CAEP_RTITEM*)data->userData);
-}
 
+    inline size_t getWriteBufferSize() const
+    {
+        return writeBufSize_;
+    }
 
-static bool
-writeBC(CAEP_RTITEM &rti)
-{
-    PWGM_ENUM_FACEORDER order = PWGM_FACEORDER_BCGROUPSONLY;
-    return 0 != PwModStreamFaces(rti.model, order, beginCB, faceCB, endCB,
-        &rti);
-}
 
+    inline unsigned getWriterThreads() const
+    {
+        return writerThreads_;
+    }
+
+
+    inline bool useMappedOutput() const
+    {
+        return mappedOutput_;
+    }
+
+
+    inline bool useFaceHashBc() const
+    {
+        return faceHashBc_;
+    }
+
+
+    inline bool useGzipRest() const
+    {
+        return gzipRest_;
+    }
+
+
+    inline bool useIncremental() const
+    {
+        return incremental_;
+    }
+
+
+    inline bool useAsyncWrite() const
+    {
+        return asyncWrite_;
+    }
+
+
+    inline bool useRcmOrder() const
+    {
+        return rcmOrder_;
+    }
+
+
+    inline CellOrder getCellOrder() const
+    {
+        return cellOrder_;
+    }
+
+
+    inline bool useWideIndices() const
+    {
+        return wideIndices_;
+    }
+
+
+    // Size in bytes of each binary REST integer
+    inline size_t getIndexSize() const
+    {
+        return wideIndices_ ? sizeof(PWP_UINT64) : sizeof(PWP_UINT32);
+    }
+
+
+    // Number of REST partition files. 1 writes a single REST file.
+    inline PWP_UINT32 getPartitionCount() const
+    {
+        return partCnt_;
+    }
+
+
+    inline bool useValidation() const
+    {
+        return validate_;
+    }
+
+
+    // Number of progress steps in the export. The REST sections are 3 steps,
+    // a partitioned export is 4 and each reordering or validation pass is
+    // one more.
+    inline PWP_UINT32 getProgressStepCount() const
+    {
+        return (partCnt_ > 1 ? 4 : 3) + (rcmOrder_ ? 1 : 0) +
+            (NativeCells != cellOrder_ ? 1 : 0) + (validate_ ? 1 : 0);
+    }
+
+
+    // Adds the model data the vertex section depends on to hash: the
+    // ModelRevision, the vertex count and the REST vertex order. The caller
+    // adds the record layout. Nothing is read from the grid model.
+    void vertexFingerprint(ADSHash64 &hash) const
+    {
+        hashRevision(hash);
+        hash.add(vertCnt_);
+        hashVec(hash, vertNewToOld_);
+    }
+
+
+    // Adds the model data the connectivity section depends on to hash: the
+    // ModelRevision, the element counts of the model and its blocks, both
+    // REST orders and the binary integer width.
+    void connectivityFingerprint(ADSHash64 &hash) const
+    {
+        hashRevision(hash);
+        hash.add(getIndexSize());
+        hash.add(elemCnt_);
+        hashVec(hash, blkElemCnts_);
+        hashVec(hash, vertNewToOld_);
+        hashVec(hash, cellNewToOld_);
+    }
+
+
+    // Adds the model data the BC face section depends on to hash: the CD
+    // tids and face counts of the domains. The records hold REST cell
+    // indices, so the ModelRevision, the REST cell order and the binary
+    // integer width are added too.
+    void bcFaceFingerprint(ADSHash64 &hash) const
+    {
+        hashRevision(hash);
+        hash.add(getIndexSize());
+        hash.add(bcFaceCnt_);
+        hashVec(hash, bcFaceCnts_);
+        hashVec(hash, prefix_);
+        hashVec(hash, cellNewToOld_);
+    }
+
+
+    // Section locations and fingerprints of the REST file being written
+    inline ADSRestManifest &manifest()
+    {
+        return manifest_;
+    }
+
+
+    // Section locations and fingerprints of the previous REST file
+    inline ADSRestManifest &prevManifest()
+    {
+        return prevManifest_;
+    }
+
+
+    // The previous REST file opened for reading or 0 if no sections can be
+    // reused. Owned by the caller.
+    inline void setPrevRestFile(FILE *fp)
+    {
+        prevRest_ = fp;
+    }
+
+
+    inline FILE *getPrevRestFile() const
+    {
+        return prevRest_;
+    }
+
+
+    inline ADSStageStats &stats()
+    {
+        return stats_;
+    }
+
+
+    inline bool writeStatsJson() const
+    {
+        return statsJson_;
+    }
+
+
+    inline ADSProgress &progress()
+    {
+        return progress_;
+    }
+
+
+private:
+
+    // Sends an error and returns false if the count named name can not be
+    // exported. The grid model enumerates items with 32-bit indices. A
+    // 32-bit binary REST integer holds a smaller range.
+    bool checkCount(const char *name, PWP_UINT64 count) const
+    {
+        std::ostringstream msg;
+        if (count > MaxModelCount) {
+            msg << name << " (" << count << ") is more than the grid model "
+                "can enumerate (" << MaxModelCount << ")!";
+        }
+        else if (!wideIndices_ && count > MaxIndex32) {
+            msg << name << " (" << count << ") does not fit in a 32-bit "
+                "REST integer. Set IndexWidth to 64bit.";
+        }
+        else {
+            return true;
+        }
+        caeuSendErrorMsg(&rti_, msg.str().c_str(), 0);
+        return false;
+    }
+
+
+    // Adds the ModelRevision to hash
+    void hashRevision(ADSHash64 &hash) const
+    {
+        hash.add(revision_.data(), revision_.size());
+        hash.add(revision_.size());
+    }
+
+
+    // Adds the size and values of vec to hash
+    static void hashVec(ADSHash64 &hash, const UINT32Vec &vec)
+    {
+        hash.add(vec.size());
+        hash.add(vec.data(), vec.size() * sizeof(PWP_UINT32));
+    }
+
+
+private:
+
+    // Runtime information
+    CAEP_RTITEM &rti_;
+
+    // Global sequence id assigned to each boundary domain. There is one item
+    // for each boundary domain in the grid model.
+    UINT32Vec   prefix_;
+
+    // Number of times each BC is used in grid model. There is one item for
+    // each BC type supported (plus one error item).
+    PWP_UINT32  bcUsageCnt_[NumBcs + 1];
+
+    // BC type id and id of each boundary domain as returned by GetBcData()
+    UINT32Vec   bcTids_;
+    UINT32Vec   bcIds_;
+
+    // BC name of each boundary domain as set in the grid model
+    StringVec   bcNames_;
+
+    // BC names formatted for ADS: "<NN>_<AdsBcTypeName>". Where, NN is the
+    // usage count for <AdsBcTypeName>.
+    StringVec   adsBcNames_;
+
+    // Number of faces in each boundary domain
+    UINT32Vec   bcFaceCnts_;
+
+    // Number of elements and VC type id of each block. The VC type id is 0
+    // if it was not scanned.
+    UINT32Vec   blkElemCnts_;
+    UINT32Vec   blkVcTids_;
+
+    // Type of every element of each block or PWGM_ELEMTYPE_SIZE if the block
+    // has more than one element type
+    std::vector<PWP_UINT8> blkElemTypes_;
+
+    // Model totals. Summed in 64 bits so an overflow can be reported.
+    PWP_UINT64  vertCnt_;
+    PWP_UINT64  elemCnt_;
+    PWP_UINT64  bcFaceCnt_;
+
+    // Type of each element in model index order. Filled by the connectivity
+    // writers, or by cacheCellTypes() if the connectivity is copied, so the
+    // BC face writer does not have to fetch the elements again.
+    std::vector<PWP_UINT8> cellTypes_;
+
+    // REST vertex order. Both are empty if the model's order is used.
+    UINT32Vec   vertNewToOld_;
+    UINT32Vec   vertOldToNew_;
+
+    // REST cell order. Both are empty if the model's order is used.
+    UINT32Vec   cellNewToOld_;
+    UINT32Vec   cellOldToNew_;
+
+    // Set of already used prefix_ values for paired BC types 13 and 14.
+    // Duplicate id usage generates a warning.
+    UINT32Set   usedPrefixPairs_;
+
+    // Number of dependent variables
+    PWP_UINT32  ndVar_;
+
+    // Size in bytes of the REST file staging buffer
+    size_t      writeBufSize_;
+
+    // Number of threads used to convert REST data. 1 is serial.
+    unsigned    writerThreads_;
+
+    // If true, the binary REST file is written through a memory mapping
+    bool        mappedOutput_;
+
+    // If true, the BC face owners are found with a parallel face hash
+    // instead of PwModStreamFaces()
+    bool        faceHashBc_;
+
+    // If true, the REST file is written as a gzip file (REST.gz)
+    bool        gzipRest_;
+
+    // If true, unchanged sections are copied from the previous REST file
+    bool        incremental_;
+
+    // Caller's revision of the grid. Sections are only reused while it is
+    // unchanged.
+    std::string revision_;
+
+    // If true, buffered REST data is written by an I/O thread while the next
+    // chunk is produced
+    bool        asyncWrite_;
+
+    // If true, the vertices are written in reverse Cuthill-McKee order
+    bool        rcmOrder_;
+
+    // Curve used to order the cells
+    CellOrder   cellOrder_;
+
+    // If true, binary REST integers are written with 64 bits
+    bool        wideIndices_;
+
+    // Number of REST partition files
+    PWP_UINT32  partCnt_;
+
+    // If true, the REST file is read back and checked after it is written
+    bool        validate_;
+
+    // Section locations and fingerprints of the new and previous REST files
+    ADSRestManifest manifest_;
+    ADSRestManifest prevManifest_;
+
+    // Previous REST file or 0
+    FILE *      prevRest_;
+
+    // Per-stage export statistics
+    ADSStageStats   stats_;
+
+    // If true, stats_ is also written to a JSON file next to the REST file
+    bool        statsJson_;
+
+    // Throttled progress reporting for the REST file sections
+    ADSProgress     progress_;
+};
+
+
+static void
+closeFile(CAEP_RTITEM &rti)
+{
+    if (0 != rti.fp) {
+        pwpFileClose(rti.fp);
+        rti.fp = 0;
+    }
+}
+
+
+static std::string
+fileName(CAEP_RTITEM &rti, const char *ext)
+{
+    std::string fname(rti.pWriteInfo->fileDest);
+    if (ext && ext[0]) {
+        fname += ".";
+        fname += ext;
+    }
+    return fname;
+}
+
+
+static bool
+openFile(CAEP_RTITEM &rti, const char *ext, PWP_ENUM_ENCODING encoding)
+{
+    closeFile(rti);
+    std::string fname = fileName(rti, ext);
+    int mode = pwpWrite;
+    if (PWP_ENCODING_BINARY == encoding) {
+        mode |= pwpBinary;
+    }
+    else {
+        mode |= pwpAscii;
+    }
+    rti.fp = pwpFileOpen(fname.c_str(), mode);
+    return 0 != rti.fp;
+}
+
+
+// Number of bytes written to the REST file through wrBuf so far
+static inline PWP_UINT64
+restBytes(CAEP_RTITEM &rti)
+{
+    return (0 == rti.wrBuf) ? 0 : rti.wrBuf->bytesAppended();
+}
+
+
+// Gets the title record of a REST file
+static std::string
+titleRecord(CAEP_RTITEM &rti)
+{
+    // get the title from set attribute -> title
+    const char* title;
+    PwModGetAttributeString(rti.model, attrTitle, &title);
+    std::string buf;
+    if (CAEPU_RT_ENC_BINARY(&rti)) {
+        // Write left-justified, 80 character, space-padded string
+        buf.assign(title, strnlen(title, 80));
+        buf.resize(80, ' ');
+    }
+    else {
+        buf = title;
+        buf += "\n\n";
+    }
+    return buf;
+}
+
+
+static bool
+writeTitle(CAEP_RTITEM &rti)
+{
+    ADSStageStats &stats = rti.adsData->stats();
+    stats.begin(ADSStageStats::Title, restBytes(rti));
+    const std::string buf = titleRecord(rti);
+    rti.wrBuf->write(buf.data(), buf.size());
+    stats.end(ADSStageStats::Title, restBytes(rti), 1, 1);
+    return true;
+}
+
+
+// Max bytes formatRecord() can produce for a record of count values. valSize
+// is the size of each binary value.
+static inline size_t
+maxRecordSize(bool binary, PWP_UINT32 count, int fldWd = 1,
+    size_t valSize = sizeof(PWP_UINT32))
+{
+    return binary ? count * valSize : count * (MaxFmtFldLen + fldWd + 1);
+}
+
+
+static inline char *
+fmtValue(char *buf, PWP_UINT32 v, int fldWd)
+{
+    return fmtUInt(buf, v, fldWd);
+}
+
+
+
+static inline char *
+fmtValue(char *buf, float v, int /*fldWd*/)
+{
+    return fmtFloat(buf, v);
+}
+
+
+static inline char *
+fmtValue(char *buf, double v, int /*fldWd*/)
+{
+    return fmtDouble(buf, v);
+}
+
+
+// Formats a record of Count values into buf. Returns a pointer just past the
+// record. Binary and Count are compile time constants so each section's
+// record loop has no encoding test and a fixed trip count. A Count of 0
+// means the count is only known at run time and is passed in count.
+template<bool Binary, PWP_UINT32 Count, typename T>
+static inline char *
+formatRecordT(char *buf, const T *var, PWP_UINT32 count = Count,
+    int fldWd = 1)
+{
+    const PWP_UINT32 n = (0 == Count) ? count : Count;
+    if (Binary) {
+        memcpy(buf, var, n * sizeof(T));
+        return buf + n * sizeof(T);
+    }
+    for (PWP_UINT32 i = 0; i < n; ++i) {
+        buf = fmtValue(buf, var[i], fldWd);
+        *buf++ = ' ';
+    }
+    // replace the last separator with a newline
+    buf[-1] = '\n';
+    return buf;
+}
+
+
+// Formats a record into buf. Returns a pointer just past the record.
+static inline char *
+formatRecord(bool binary, char *buf, const PWP_UINT32 *var, PWP_UINT32 count,
+    int fldWd = 1)
+{
+    return binary ? formatRecordT<true, 0>(buf, var, count, fldWd) :
+        formatRecordT<false, 0>(buf, var, count, fldWd);
+}
+
+
+// Appends a record of Count values to wrBuf
+template<bool Binary, PWP_UINT32 Count, typename T>
+static inline void
+writeRecordT(ADSWriteBuffer &wrBuf, const T *var, PWP_UINT32 count = Count,
+    int fldWd = 1)
+{
+    const PWP_UINT32 n = (0 == Count) ? count : Count;
+    char *buf = wrBuf.reserve(maxRecordSize(Binary, n, fldWd, sizeof(T)));
+    wrBuf.commit(formatRecordT<Binary, Count>(buf, var, n, fldWd) - buf);
+}
+
+
+// Copies count values at var into buf as 64-bit integers. Returns a pointer
+// just past them.
+static inline char *
+formatWideRecord(char *buf, const PWP_UINT32 *var, size_t count)
+{
+    for (size_t i = 0; i < count; ++i) {
+        const PWP_UINT64 v = var[i];
+        memcpy(buf, &v, sizeof(v));
+        buf += sizeof(v);
+    }
+    return buf;
+}
+
+
+// Appends count binary REST integers to wrBuf with 64 bits if wide is true.
+// 32-bit values are copied as is.
+static void
+writeIndices(ADSWriteBuffer &wrBuf, bool wide, const PWP_UINT32 *var,
+    size_t count)
+{
+    if (!wide) {
+        wrBuf.writeRecord(var, count);
+        return;
+    }
+    const size_t BlockSize = 4096;
+    while (0 != count) {
+        const size_t n = std::min(count, BlockSize);
+        char *buf = wrBuf.reserve(n * sizeof(PWP_UINT64));
+        wrBuf.commit(formatWideRecord(buf, var, n) - buf);
+        var += n;
+        count -= n;
+    }
+}
+
+
+// Appends count binary REST integers to the REST file at the export's index
+// width
+static inline void
+writeIndices(CAEP_RTITEM &rti, const PWP_UINT32 *var, size_t count)
+{
+    writeIndices(*rti.wrBuf, rti.adsData->useWideIndices(), var, count);
+}
+
+
+// Writes one header record. The per-section writers use writeRecordT().
+static inline void
+writeArray(CAEP_RTITEM &rti, PWP_UINT32 *var, PWP_UINT32 count, int fldWd = 1)
+{
+    if (CAEPU_RT_ENC_BINARY(&rti)) {
+        writeIndices(rti, var, count);
+        return;
+    }
+    // Format the whole record straight into the write buffer
+    char *buf = rti.wrBuf->reserve(maxRecordSize(false, count, fldWd));
+    rti.wrBuf->commit(formatRecord(false, buf, var, count, fldWd) - buf);
+}
+
+
+static bool
+writeZeroLine(CAEP_RTITEM &rti)
+{
+    const PWP_UINT32 VARSZ = 15;
+    // init var[] to all zeros
+    PWP_UINT32 var[VARSZ] = { 0 };
+    writeArray(rti, var, VARSZ);
+    return true;
+}
+
+
+static bool
+writeFirstLine(CAEP_RTITEM &rti)
+{
+    // nsector,nisbc,ndvar,imesh,niter,itime,inrit,units,nitsc,nbk,5xIDM
+    const PWP_UINT32 VARSZ = 15;
+    // init var[] to all zeros
+    PWP_UINT32 var[VARSZ] = { 0 };
+    // set values accordingly
+    var[0] = 1; // NSECTIONS
+    var[2] = rti.adsData->getNDVAR(); // NDVAR
+    var[6] = rti.adsData->getBlockCount(); // NBK
+    writeArray(rti, var, VARSZ);
+    return true;
+}
+
+
+static bool
+writeSecondLine(CAEP_RTITEM &rti)
+{
+    // rinpax,uinpav,gc,gal,dtin,tmacc,9xIDM
+    return writeZeroLine(rti);
+}
+
+
+static bool
+writeThirdLine(CAEP_RTITEM &rti)
+{
+    // nnl,nel,nbcl,ngrid,ncdut,nsfl,bksl,8xIDM
+    const PWP_UINT32 VARSZ = 15;
+    // init var[] to all zeros
+    PWP_UINT32 var[VARSZ] = { 0 };
+    // set values accordingly
+    var[0] = rti.adsData->getVertexCount(); // NNL
+    var[1] = rti.adsData->getElementCount(); // NEL
+    var[2] = rti.adsData->getBoundaryFaceCount(); // NBCL
+    var[4] = rti.adsData->getNDVAR(); // NCDUT
+    writeArray(rti, var, VARSZ);
+    return true;
+}
+
+
+static bool
+writeFourthLine(CAEP_RTITEM &rti)
+{
+    // rpms,pgaug,egaug,fvs,sfrl,twal,pnll,pntl,tfree,lfree,5xIDM
+    return writeZeroLine(rti);
+}
+
+
+static bool
+writeHeader(CAEP_RTITEM &rti)
+{
+    ADSStageStats &stats = rti.adsData->stats();
+    stats.begin(ADSStageStats::Header, restBytes(rti));
+    const bool ret = writeFirstLine(rti) && writeSecondLine(rti) &&
+        writeThirdLine(rti) && writeFourthLine(rti);
+    // The header values come from the ADSData model summary
+    stats.end(ADSStageStats::Header, restBytes(rti), 4, 0);
+    return ret;
+}
+
+
+// Max number of values in a vertex record: XYZ + dep vars + PSND
+const PWP_UINT32 MaxVertRecord = 3 + 15;
+
+
+// Sets count to the number of values written for each vertex. Returns false
+// if NDVAR is too large.
+static bool
+vertexRecordCount(CAEP_RTITEM &rti, PWP_UINT32 &count)
+{
+    const PWP_UINT32 VARSZ = MaxVertRecord - 3;
+    PWP_UINT32 NVAR = rti.adsData->getNDVAR();
+    // Array bounds check. Use >= to allow for PSND value
+    if (NVAR >= VARSZ) {
+        return false;
+    }
+    // Number of values to write for each vertex == xyz + dep var count
+    count = 3 + NVAR;
+    if (1 != NVAR) {
+        // PSND gets written too
+        ++count;
+    }
+    return true;
+}
+
+
+// Loads the constant part of a vertex record into var and sets count to the
+// number of values written for each vertex. Returns false if NDVAR is too
+// large. Real is the precision of the vertex section.
+template<typename Real>
+static bool
+initVertexRecord(CAEP_RTITEM &rti, Real *var, PWP_UINT32 &count)
+{
+    const Real DVAR = 0.0;
+    const Real PSND = 0.0;
+    if (!vertexRecordCount(rti, count)) {
+        return false;
+    }
+    // init var[] to all zeros. XYZ are set for each vertex. The values after
+    // XYZ don't change. Set them once up front.
+    for (PWP_UINT32 i = 0; i < MaxVertRecord; ++i) {
+        var[i] = 0.0;
+    }
+    for (PWP_UINT32 i = 3; i < count; ++i) {
+        var[i] = DVAR;
+    }
+    if (1 != rti.adsData->getNDVAR()) {
+        var[count - 1] = PSND;
+    }
+    return true;
+}
+
+
+// Size in bytes of each binary vertex record value
+static inline size_t
+vertexValueSize(CAEP_RTITEM &rti)
+{
+    return CAEPU_RT_PREC_DOUBLE(&rti) ? sizeof(double) : sizeof(float);
+}
+
+
+// Copies the XYZ of v into the first 3 values of a vertex record
+template<typename Real>
+static inline void
+setVertexXYZ(Real *var, const PWGM_VERTDATA &v)
+{
+    var[0] = Real(v.x);
+    var[1] = Real(v.y);
+    var[2] = Real(v.z);
+}
+
+
+// Fetches the vertices at REST positions [beg, end) into batch. The batch
+// arrays come from the calling thread's arena, so they are valid until the
+// thread's next fetch.
+static bool
+fetchVertices(CAEP_RTITEM &rti, PWP_UINT32 beg, PWP_UINT32 end,
+    ADSVertexBatch &batch)
+{
+    ADSArena &arena = ADSArena::local();
+    arena.reset();
+    batch.init(arena, beg, end - beg);
+    PWGM_VERTDATA v;
+    for (PWP_UINT32 vNdx = beg; vNdx < end; ++vNdx) {
+        if (!PwVertDataMod(PwModEnumVertices(rti.model,
+                rti.adsData->modelVertex(vNdx)), &v)) {
+            return false;
+        }
+        batch.set(vNdx - beg, v);
+    }
+    return true;
+}
+
+
+// Formats the records of the vertices in batch into buf. var is a vertex
+// record with the values after XYZ set. Returns a pointer just past the last
+// record. Binary records are converted by the adsVertexRecords() kernel.
+template<bool Binary, PWP_UINT32 Count, typename Real>
+static inline char *
+formatVertices(char *buf, const ADSVertexBatch &batch, Real *var,
+    PWP_UINT32 count)
+{
+    const PWP_UINT32 n = batch.getCount();
+    if (Binary) {
+        return adsVertexRecords(batch.x(), batch.y(), batch.z(), n, var,
+            count, buf);
+    }
+    for (PWP_UINT32 i = 0; i < n; ++i) {
+        var[0] = Real(batch.x()[i]);
+        var[1] = Real(batch.y()[i]);
+        var[2] = Real(batch.z()[i]);
+        buf = formatRecordT<false, Count>(buf, var, count);
+    }
+    return buf;
+}
+
+
+// Worker threads fetch and format chunks of vertices. The chunks are written
+// in order so the result is identical to the serial loop in
+// writeVertexSection().
+template<bool Binary, PWP_UINT32 Count, typename Real>
+static bool
+writeVerticesMT(CAEP_RTITEM &rti, const Real *var0, PWP_UINT32 count)
+{
+    typedef std::vector<char> CharVec;
+    const size_t recSize = maxRecordSize(Binary, count, 1, sizeof(Real));
+
+    auto fill = [&](PWP_UINT32 beg, PWP_UINT32 end, CharVec &buf) {
+        Real var[MaxVertRecord];
+        memcpy(var, var0, sizeof(var));
+        buf.resize((end - beg) * recSize);
+        char *p = &buf[0];
+        ADSVertexBatch batch;
+        auto format = [&](PWP_UINT32 vNdx, PWP_UINT32 n) {
+            if (!fetchVertices(rti, vNdx, vNdx + n, batch)) {
+                return false;
+            }
+            p = formatVertices<Binary, Count>(p, batch, var, count);
+            return true;
+        };
+        if (!adsForBatches(beg, end, FetchBatch, format)) {
+            return false;
+        }
+        buf.resize(p - &buf[0]);
+        return true;
+    };
+
+    auto emit = [&](PWP_UINT32 beg, PWP_UINT32 end, CharVec &buf) {
+        rti.wrBuf->write(&buf[0], buf.size());
+        return rti.adsData->progress().incr(end - beg);
+    };
+
+    return adsRunOrdered<CharVec>(rti.adsData->getVertexCount(), MTChunkSize,
+        rti.adsData->getWriterThreads(), fill, emit);
+}
+
+
+// Worker threads fetch vertices and write their binary records straight to
+// their final location in the memory-mapped REST file at dest.
+template<typename Real>
+static bool
+writeVerticesMapped(CAEP_RTITEM &rti, char *dest)
+{
+    bool ret = false;
+    Real var0[MaxVertRecord];
+    PWP_UINT32 count;
+    if (!initVertexRecord(rti, var0, count)) {
+        CAEPU_RT_ABORT(&rti);
+    }
+    else {
+        const PWP_UINT32 vertCnt = rti.adsData->getVertexCount();
+        const size_t recSize = count * sizeof(Real);
+        auto work = [&](PWP_UINT32 beg, PWP_UINT32 end) {
+            Real var[MaxVertRecord];
+            memcpy(var, var0, sizeof(var));
+            char *p = dest + size_t(beg) * recSize;
+            ADSVertexBatch batch;
+            auto format = [&](PWP_UINT32 vNdx, PWP_UINT32 n) {
+                if (!fetchVertices(rti, vNdx, vNdx + n, batch)) {
+                    return false;
+                }
+                p = formatVertices<true, 0>(p, batch, var, count);
+                return true;
+            };
+            return adsForBatches(beg, end, FetchBatch, format);
+        };
+        auto progress = [&](PWP_UINT32 items) {
+            return rti.adsData->progress().incr(items);
+        };
+        ADSStageStats &stats = rti.adsData->stats();
+        stats.begin(ADSStageStats::Vertices);
+        if (rti.adsData->progress().beginStep(vertCnt)) {
+            ret = adsParallelFor(vertCnt, MTChunkSize,
+                rti.adsData->getWriterThreads(), work, progress);
+        }
+        rti.adsData->progress().endStep();
+        stats.end(ADSStageStats::Vertices, vertCnt * recSize, vertCnt,
+            2 * PWP_UINT64(vertCnt));
+    }
+    return ret;
+}
+
+
+static bool
+writeVerticesMapped(CAEP_RTITEM &rti, char *dest)
+{
+    return CAEPU_RT_PREC_DOUBLE(&rti) ?
+        writeVerticesMapped<double>(rti, dest) :
+        writeVerticesMapped<float>(rti, dest);
+}
+
+
+// Writes the vertex records. Count is the record width or 0 if it is not
+// one of the specialized widths.
+template<bool Binary, PWP_UINT32 Count, typename Real>
+static bool
+writeVertexSection(CAEP_RTITEM &rti, Real *var, PWP_UINT32 count)
+{
+    if (1 < rti.adsData->getWriterThreads()) {
+        return writeVerticesMT<Binary, Count>(rti, var, count);
+    }
+    ADSWriteBuffer &wrBuf = *rti.wrBuf;
+    ADSProgress &progress = rti.adsData->progress();
+    const PWP_UINT32 vertCnt = rti.adsData->getVertexCount();
+    const size_t recSize = maxRecordSize(Binary, count, 1, sizeof(Real));
+    ADSVertexBatch batch;
+    auto write = [&](PWP_UINT32 vNdx, PWP_UINT32 n) {
+        if (!fetchVertices(rti, vNdx, vNdx + n, batch)) {
+            return false;
+        }
+        char *buf = wrBuf.reserve(n * recSize);
+        wrBuf.commit(formatVertices<Binary, Count>(buf, batch, var, count) -
+            buf);
+        return progress.incr(n);
+    };
+    return adsForBatches(0, vertCnt, FetchBatch, write);
+}
+
+
+// Picks the vertex section writer for the export's encoding and record
+// width. The widths for the Solid (NDVAR 1) and Fluid (NDVAR 5) VC types
+// are specialized. Other widths use the run time count.
+template<typename Real>
+static bool
+writeVertexSection(CAEP_RTITEM &rti, Real *var, PWP_UINT32 count)
+{
+    typedef bool (*SectionFunc)(CAEP_RTITEM &rti, Real *var,
+        PWP_UINT32 count);
+    const bool binary = (0 != CAEPU_RT_ENC_BINARY(&rti));
+    SectionFunc writeSection;
+    switch (count) {
+    case 4:
+        writeSection = binary ? writeVertexSection<true, 4, Real> :
+            writeVertexSection<false, 4, Real>;
+        break;
+    case 9:
+        writeSection = binary ? writeVertexSection<true, 9, Real> :
+            writeVertexSection<false, 9, Real>;
+        break;
+    default:
+        writeSection = binary ? writeVertexSection<true, 0, Real> :
+            writeVertexSection<false, 0, Real>;
+        break;
+    }
+    return writeSection(rti, var, count);
+}
+
+
+// Writes a REST section that an incremental export can reuse. If hash and
+// sample match the same section of the previous export, the section is
+// copied from the previous REST file and reused is set. Otherwise, write()
+// is called. A matching hash with a changed sample means the grid changed
+// but the ModelRevision did not, so a warning is sent.
+template<typename WriteFunc>
+static bool
+writeOrReuse(CAEP_RTITEM &rti, ADSRestManifest::Section s, PWP_UINT64 hash,
+    PWP_UINT64 sample, WriteFunc write, bool &reused)
+{
+    ADSData &adsData = *rti.adsData;
+    const ADSRestManifest::Entry &prev = adsData.prevManifest().get(s);
+    const PWP_UINT64 offset = restBytes(rti);
+    reused = (0 != adsData.getPrevRestFile()) && prev.valid &&
+        (hash == prev.hash);
+    if (reused && sample != prev.sample) {
+        reused = false;
+        std::ostringstream msg;
+        msg << "The grid data of the REST " << ADSRestManifest::name(s) <<
+            " section changed but the ModelRevision did not. Writing the "
+            "section.";
+        caeuSendWarningMsg(&rti, msg.str().c_str(), 0);
+    }
+    const bool ret = reused ?
+        rti.wrBuf->copyFrom(adsData.getPrevRestFile(), prev.offset,
+            prev.bytes) :
+        write();
+    if (ret) {
+        adsData.manifest().set(s, hash, sample, offset,
+            restBytes(rti) - offset);
+    }
+    return ret;
+}
+
+
+// Calls sample(ndx) for up to GuardSamples item indices spread evenly over
+// [0, count), including the first and last. Stops at the first call that
+// returns false.
+template<typename SampleFunc>
+static void
+forGuardSamples(PWP_UINT32 count, SampleFunc sample)
+{
+    const PWP_UINT32 n = std::min(count, GuardSamples);
+    for (PWP_UINT32 i = 0; i < n; ++i) {
+        const PWP_UINT32 ndx = (1 == n) ? 0 :
+            PWP_UINT32(PWP_UINT64(i) * (count - 1) / (n - 1));
+        if (!sample(ndx)) {
+            break;
+        }
+    }
+}
+
+
+// Hashes the XYZ of a sparse sample of the model vertices. Adds the grid
+// model calls made to gridCalls.
+static PWP_UINT64
+vertexSample(CAEP_RTITEM &rti, PWP_UINT64 &gridCalls)
+{
+    ADSHash64 hash(ADSRestManifest::Vertices);
+    PWGM_VERTDATA v;
+    forGuardSamples(rti.adsData->getVertexCount(), [&](PWP_UINT32 ndx) {
+        gridCalls += 2;
+        if (!PwVertDataMod(PwModEnumVertices(rti.model, ndx), &v)) {
+            return false;
+        }
+        hash.add(ndx);
+        hash.add(v.x);
+        hash.add(v.y);
+        hash.add(v.z);
+        return true;
+    });
+    return hash.value();
+}
+
+
+// Hashes the types and vertices of a sparse sample of the model elements.
+// Adds the grid model calls made to gridCalls.
+static PWP_UINT64
+connectivitySample(CAEP_RTITEM &rti, PWP_UINT64 &gridCalls)
+{
+    ADSHash64 hash(ADSRestManifest::Connectivity);
+    PWGM_ELEMDATA eData;
+    forGuardSamples(rti.adsData->getElementCount(), [&](PWP_UINT32 ndx) {
+        gridCalls += 2;
+        if (!PwElemDataMod(PwModEnumElements(rti.model, ndx), &eData)) {
+            return false;
+        }
+        hash.add(ndx);
+        hash.add(eData.type);
+        hash.add(eData.index, eData.vertCnt * sizeof(PWP_UINT32));
+        return true;
+    });
+    return hash.value();
+}
+
+
+// Hashes the vertices of a sparse sample of the domain elements, in BC
+// record order. Adds the grid model calls made to gridCalls.
+static PWP_UINT64
+bcFaceSample(CAEP_RTITEM &rti, PWP_UINT64 &gridCalls)
+{
+    const ADSData &adsData = *rti.adsData;
+    ADSHash64 hash(ADSRestManifest::BcFaces);
+    PWGM_ELEMDATA eData;
+    PWP_UINT32 dom = 0;
+    // first BC record of dom
+    PWP_UINT32 first = 0;
+    PWGM_HDOMAIN hDom = PwModEnumDomains(rti.model, dom);
+    ++gridCalls;
+    forGuardSamples(adsData.getBoundaryFaceCount(), [&](PWP_UINT32 r) {
+        while (r - first >= adsData.getBoundaryFaceCount(dom)) {
+            first += adsData.getBoundaryFaceCount(dom);
+            hDom = PwModEnumDomains(rti.model, ++dom);
+            ++gridCalls;
+        }
+        gridCalls += 2;
+        if (!PwElemDataMod(PwDomEnumElements(hDom, r - first), &eData)) {
+            return false;
+        }
+        hash.add(r);
+        hash.add(eData.index, eData.vertCnt * sizeof(PWP_UINT32));
+        return true;
+    });
+    return hash.value();
+}
+
+
+// Fingerprints the vertex section: its model data, the precision and the
+// record layout and values that are the same in every record. The
+// coordinates are covered by the ModelRevision and vertexSample().
+template<typename Real>
+static PWP_UINT64
+vertexFingerprint(CAEP_RTITEM &rti, const Real *var, PWP_UINT32 count)
+{
+    ADSHash64 hash(ADSRestManifest::Vertices);
+    rti.adsData->vertexFingerprint(hash);
+    hash.add(sizeof(Real));
+    hash.add(count);
+    hash.add(var, count * sizeof(Real));
+    return hash.value();
+}
+
+
+template<typename Real>
+static bool
+writeVertices(CAEP_RTITEM &rti)
+{
+    bool ret = false;
+    Real var[MaxVertRecord];
+    PWP_UINT32 count;
+    if (!initVertexRecord(rti, var, count)) {
+        CAEPU_RT_ABORT(&rti);
+    }
+    else {
+        ADSStageStats &stats = rti.adsData->stats();
+        stats.begin(ADSStageStats::Vertices, restBytes(rti));
+        const PWP_UINT32 vertCnt = rti.adsData->getVertexCount();
+        bool reused = false;
+        PWP_UINT64 sampleCalls = 0;
+        if (rti.adsData->progress().beginStep(vertCnt)) {
+            auto write = [&]() {
+                return writeVertexSection(rti, var, count);
+            };
+            ret = rti.adsData->useIncremental() ?
+                writeOrReuse(rti, ADSRestManifest::Vertices,
+                    vertexFingerprint(rti, var, count),
+                    vertexSample(rti, sampleCalls), write, reused) :
+                write();
+        }
+        rti.adsData->progress().endStep();
+        stats.end(ADSStageStats::Vertices, restBytes(rti), vertCnt,
+            (reused ? 0 : 2 * PWP_UINT64(vertCnt) + 2) + sampleCalls);
+    }
+    return ret;
+}
+
+
+// The precision is fixed for the whole export. Pick the vertex pipeline once.
+static bool
+writeVertices(CAEP_RTITEM &rti)
+{
+    return CAEPU_RT_PREC_DOUBLE(&rti) ? writeVertices<double>(rti) :
+        writeVertices<float>(rti);
+}
+
+
+// Loads the ADS connectivity record for eData into ndx
+static inline void
+elemIndices(const ADSData &adsData, const PWGM_ELEMDATA &eData,
+    PWP_UINT32 *ndx)
+{
+    adsData.restIndices(eData, ndx);
+}
+
+
+// Fetches the cells at REST positions [beg, end) into batch and caches
+// their types. The batch arrays come from the calling thread's arena, so
+// they are valid until the thread's next fetch.
+static bool
+fetchElements(CAEP_RTITEM &rti, PWP_UINT32 beg, PWP_UINT32 end,
+    ADSElemBatch &batch)
+{
+    ADSArena &arena = ADSArena::local();
+    arena.reset();
+    batch.init(arena, beg, end - beg);
+    PWGM_ELEMDATA eData;
+    for (PWP_UINT32 r = beg; r < end; ++r) {
+        const PWP_UINT32 eNdx = rti.adsData->modelCell(r);
+        if (!PwElemDataMod(PwModEnumElements(rti.model, eNdx), &eData) ||
+                !batch.add(eData)) {
+            return false;
+        }
+        rti.adsData->setCellType(eNdx, eData.type);
+    }
+    return true;
+}
+
+
+// Worker threads fetch chunks of elements and convert them into 8-wide index
+// buffers. ASCII text is also formatted by the workers. The chunks are
+// written in order so the result is identical to the serial loop in
+// writeConnectivitySection().
+template<bool Binary>
+static bool
+writeConnectivityMT(CAEP_RTITEM &rti, PWP_UINT32 elemCnt)
+{
+    struct Chunk {
+        std::vector<PWP_UINT32> ndx;
+        std::vector<char>       text;
+    };
+    const PWP_UINT32 RecSize = PWGM_ELEMDATA_VERT_SIZE;
+
+    auto fill = [&](PWP_UINT32 beg, PWP_UINT32 end, Chunk &chunk) {
+        const PWP_UINT32 cnt = end - beg;
+        chunk.ndx.resize(cnt * RecSize);
+        ADSElemBatch batch;
+        auto convert = [&](PWP_UINT32 r, PWP_UINT32 n) {
+            if (!fetchElements(rti, r, r + n, batch)) {
+                return false;
+            }
+            rti.adsData->restIndices(batch,
+                &chunk.ndx[size_t(r - beg) * RecSize]);
+            return true;
+        };
+        if (!adsForBatches(beg, end, FetchBatch, convert)) {
+            return false;
+        }
+        if (!Binary) {
+            chunk.text.resize(cnt * maxRecordSize(Binary, RecSize, 5));
+            char *p = &chunk.text[0];
+            for (PWP_UINT32 i = 0; i < cnt; ++i) {
+                p = formatRecordT<Binary, RecSize>(p, &chunk.ndx[i * RecSize],
+                    RecSize, 5);
+            }
+            chunk.text.resize(p - &chunk.text[0]);
+        }
+        return true;
+    };
+
+    auto emit = [&](PWP_UINT32 beg, PWP_UINT32 end, Chunk &chunk) {
+        if (Binary) {
+            writeIndices(rti, &chunk.ndx[0], chunk.ndx.size());
+        }
+        else {
+            rti.wrBuf->write(&chunk.text[0], chunk.text.size());
+        }
+        return rti.adsData->progress().incr(end - beg);
+    };
+
+    return adsRunOrdered<Chunk>(elemCnt, MTChunkSize,
+        rti.adsData->getWriterThreads(), fill, emit);
+}
+
+
+// Worker threads fetch elements and write their binary records straight to
+// their final location in the memory-mapped REST file at dest.
+static bool
+writeConnectivityMapped(CAEP_RTITEM &rti, char *dest)
+{
+    const bool wide = rti.adsData->useWideIndices();
+    const size_t RecSize = PWGM_ELEMDATA_VERT_SIZE *
+        rti.adsData->getIndexSize();
+    auto work = [&](PWP_UINT32 beg, PWP_UINT32 end) {
+        char *p = dest + size_t(beg) * RecSize;
+        ADSElemBatch batch;
+        auto convert = [&](PWP_UINT32 r, PWP_UINT32 n) {
+            if (!fetchElements(rti, r, r + n, batch)) {
+                return false;
+            }
+            if (wide) {
+                PWP_UINT32 *ndx = ADSArena::local().alloc<PWP_UINT32>(
+                    n * PWGM_ELEMDATA_VERT_SIZE);
+                rti.adsData->restIndices(batch, ndx);
+                p = formatWideRecord(p, ndx, n * PWGM_ELEMDATA_VERT_SIZE);
+            }
+            else {
+                // the records go straight to the file
+                rti.adsData->restIndices(batch, (PWP_UINT32*)p);
+                p += n * RecSize;
+            }
+            return true;
+        };
+        return adsForBatches(beg, end, FetchBatch, convert);
+    };
+    auto progress = [&](PWP_UINT32 items) {
+        return rti.adsData->progress().incr(items);
+    };
+    bool ret = false;
+    ADSStageStats &stats = rti.adsData->stats();
+    stats.begin(ADSStageStats::Connectivity);
+    PWP_UINT32 elemCnt = rti.adsData->getElementCount();
+    rti.adsData->initCellTypes();
+    if (rti.adsData->progress().beginStep(elemCnt)) {
+        ret = adsParallelFor(elemCnt, MTChunkSize,
+            rti.adsData->getWriterThreads(), work, progress);
+    }
+    rti.adsData->progress().endStep();
+    stats.end(ADSStageStats::Connectivity, elemCnt * RecSize, elemCnt,
+        2 * PWP_UINT64(elemCnt));
+    return ret;
+}
+
+
+template<bool Binary>
+static bool
+writeConnectivitySection(CAEP_RTITEM &rti, PWP_UINT32 elemCnt)
+{
+    if (1 < rti.adsData->getWriterThreads()) {
+        return writeConnectivityMT<Binary>(rti, elemCnt);
+    }
+    ADSWriteBuffer &wrBuf = *rti.wrBuf;
+    ADSProgress &progress = rti.adsData->progress();
+    const PWP_UINT32 RecSize = PWGM_ELEMDATA_VERT_SIZE;
+    ADSElemBatch batch;
+    auto write = [&](PWP_UINT32 r, PWP_UINT32 n) {
+        if (!fetchElements(rti, r, r + n, batch)) {
+            return false;
+        }
+        PWP_UINT32 *ndx = ADSArena::local().alloc<PWP_UINT32>(n * RecSize);
+        rti.adsData->restIndices(batch, ndx);
+        if (Binary) {
+            writeIndices(rti, ndx, n * RecSize);
+        }
+        else {
+            for (PWP_UINT32 i = 0; i < n; ++i) {
+                writeRecordT<false, RecSize>(wrBuf, ndx + i * RecSize,
+                    RecSize, 5);
+            }
+        }
+        return progress.incr(n);
+    };
+    // iterate over all elements in REST order
+    return adsForBatches(0, elemCnt, FetchBatch, write);
+}
+
+
+// Fills the cell type cache when the connectivity section is copied
+// instead of written, so the BC face writer still finds every owner's type
+// there. Blocks with one element type are filled from their element counts.
+// Only the elements of the other blocks are fetched, on the writer threads.
+// Adds the grid model calls made to gridCalls.
+static bool
+cacheCellTypes(CAEP_RTITEM &rti, PWP_UINT64 &gridCalls)
+{
+    ADSData &adsData = *rti.adsData;
+    auto progress = [&](PWP_UINT32) {
+        return !adsData.progress().aborted();
+    };
+    bool ret = true;
+    PWP_UINT32 first = 0;
+    for (PWP_UINT32 b = 0; ret && b < adsData.getBlockCount(); ++b) {
+        const PWP_UINT32 cnt = adsData.getBlockElementCount(b);
+        PWGM_ENUM_ELEMTYPE type;
+        if (adsData.getBlockElementType(b, type)) {
+            adsData.setCellTypes(first, cnt, type);
+        }
+        else {
+            auto work = [&](PWP_UINT32 beg, PWP_UINT32 end) {
+                PWGM_ELEMDATA eData;
+                for (PWP_UINT32 eNdx = first + beg; eNdx < first + end;
+                        ++eNdx) {
+                    if (!PwElemDataMod(PwModEnumElements(rti.model, eNdx),
+                            &eData)) {
+                        return false;
+                    }
+                    adsData.setCellType(eNdx, eData.type);
+                }
+                return true;
+            };
+            ret = adsParallelFor(cnt, MTChunkSize,
+                adsData.getWriterThreads(), work, progress);
+            gridCalls += 2 * PWP_UINT64(cnt);
+        }
+        first += cnt;
+    }
+    return ret;
+}
+
+
+// Fingerprints the connectivity section. The elements are covered by the
+// ModelRevision and connectivitySample().
+static PWP_UINT64
+connectivityFingerprint(CAEP_RTITEM &rti)
+{
+    ADSHash64 hash(ADSRestManifest::Connectivity);
+    rti.adsData->connectivityFingerprint(hash);
+    return hash.value();
+}
+
+
+static bool
+writeConnectivity(CAEP_RTITEM &rti)
+{
+    bool ret = false;
+    ADSStageStats &stats = rti.adsData->stats();
+    stats.begin(ADSStageStats::Connectivity, restBytes(rti));
+    PWP_UINT32 elemCnt = rti.adsData->getElementCount();
+    rti.adsData->initCellTypes();
+    bool reused = false;
+    PWP_UINT64 sampleCalls = 0;
+    PWP_UINT64 typeCalls = 0;
+    if (rti.adsData->progress().beginStep(elemCnt)) {
+        auto write = [&]() {
+            return CAEPU_RT_ENC_BINARY(&rti) ?
+                writeConnectivitySection<true>(rti, elemCnt) :
+                writeConnectivitySection<false>(rti, elemCnt);
+        };
+        ret = rti.adsData->useIncremental() ?
+            writeOrReuse(rti, ADSRestManifest::Connectivity,
+                connectivityFingerprint(rti),
+                connectivitySample(rti, sampleCalls), write, reused) :
+            write();
+        if (ret && reused) {
+            ret = cacheCellTypes(rti, typeCalls);
+        }
+    }
+    rti.adsData->progress().endStep();
+    stats.end(ADSStageStats::Connectivity, restBytes(rti), elemCnt,
+        (reused ? typeCalls : 2 * PWP_UINT64(elemCnt) + 2) + sampleCalls);
+    return ret;
+}
+
+
+// Max number of faces on any element type
+const PWP_UINT32 MaxElemFaces = 6;
+
+// ADS local face index used for an unknown element type or face
+const PWP_UINT32 BadFaceIndex = 9999;
+
+static_assert(PWGM_ELEMTYPE_PYRAMID == 6 && PWGM_ELEMTYPE_SIZE == 8,
+    "AdsFaceMap rows must match the PWGM_ENUM_ELEMTYPE order");
+
+// Converts a PW local face index to an ADS local face index. Rows are in
+// PWGM_ENUM_ELEMTYPE order.
+static constexpr PWP_UINT32 AdsFaceMap[PWGM_ELEMTYPE_SIZE][MaxElemFaces] = {
+    // BAR
+    { BadFaceIndex, BadFaceIndex, BadFaceIndex, BadFaceIndex, BadFaceIndex,
+      BadFaceIndex },
+    // HEX
+    { 5, 6, 3, 2, 4, 1 },
+    // QUAD
+    { BadFaceIndex, BadFaceIndex, BadFaceIndex, BadFaceIndex, BadFaceIndex,
+      BadFaceIndex },
+    // TRI
+    { BadFaceIndex, BadFaceIndex, BadFaceIndex, BadFaceIndex, BadFaceIndex,
+      BadFaceIndex },
+    // TET
+    { 4, 3, 1, 2, BadFaceIndex, BadFaceIndex },
+    // WEDGE
+    { 5, 1, 3, 4, 2, BadFaceIndex },
+    // PYRAMID
+    { 1, 2, 3, 4, 5, BadFaceIndex },
+    // POINT
+    { BadFaceIndex, BadFaceIndex, BadFaceIndex, BadFaceIndex, BadFaceIndex,
+      BadFaceIndex },
+};
+
+
+static inline PWP_UINT32
+fixFace(PWGM_ENUM_ELEMTYPE eType, PWP_UINT32 pwFaceNdx)
+{
+    return (PWP_UINT32(eType) < PWGM_ELEMTYPE_SIZE &&
+        pwFaceNdx < MaxElemFaces) ? AdsFaceMap[eType][pwFaceNdx] :
+        BadFaceIndex;
+}
+
+
+// Boundary face records collected by faceCB() and written as one block
+struct BcFaceBatch {
+    enum {
+        // Max number of records in a batch
+        Size = 4096,
+
+        // Number of values in a record
+        RecSize = 3
+    };
+
+    BcFaceBatch(CAEP_RTITEM &rti) :
+        rti(rti),
+        cnt(0),
+        recs(Size * RecSize),
+        out(0)
+    {
+    }
+
+    CAEP_RTITEM &           rti;
+    PWP_UINT32              cnt;
+    std::vector<PWP_UINT32> recs;
+
+    // If set, the records are appended to out instead of being written
+    std::vector<PWP_UINT32> *out;
+};
+
+
+// Writes the batched records and makes their progress increments. Returns
+// false if aborted.
+template<bool Binary>
+static bool
+flushBcFaces(BcFaceBatch &batch)
+{
+    const PWP_UINT32 *rec = batch.recs.data();
+    if (0 != batch.out) {
+        batch.out->insert(batch.out->end(), rec,
+            rec + batch.cnt * BcFaceBatch::RecSize);
+    }
+    else if (Binary) {
+        writeIndices(batch.rti, rec, batch.cnt * BcFaceBatch::RecSize);
+    }
+    else {
+        for (PWP_UINT32 i = 0; i < batch.cnt; ++i) {
+            writeRecordT<false, BcFaceBatch::RecSize>(*batch.rti.wrBuf, rec);
+            rec += BcFaceBatch::RecSize;
+        }
+    }
+    const PWP_UINT32 cnt = batch.cnt;
+    batch.cnt = 0;
+    return batch.rti.adsData->progress().incr(cnt);
+}
+
+
+PWP_UINT32 beginCB(PWGM_BEGINSTREAM_DATA *data)
+{
+    // set starting progress step count
+    CAEP_RTITEM &rti = ((BcFaceBatch*)data->userData)->rti;
+    // faceCB() writes one record per face. The cell types come from the
+    // cache filled by the connectivity writers.
+    rti.adsData->stats().addCounts(ADSStageStats::BcFaces,
+        data->totalNumFaces, 0);
+    return rti.adsData->progress().beginStep(data->totalNumFaces);
+}
+
+
+template<bool Binary>
+PWP_UINT32 faceCB(PWGM_FACESTREAM_DATA *data)
+{
+    BcFaceBatch &batch = *((BcFaceBatch*)data->userData);
+    const ADSData &adsData = *batch.rti.adsData;
+    PWGM_ENUM_ELEMTYPE eType;
+    PWGM_ELEMDATA faceElemData;
+    if (adsData.getCellType(data->owner.cellIndex, eType)) {
+        // cached by the connectivity writers
+    }
+    else if (PwElemDataMod(data->owner.blockElem, &faceElemData)) {
+        eType = faceElemData.type;
+        batch.rti.adsData->stats().addCounts(ADSStageStats::BcFaces, 0, 1);
+    }
+    else {
+        return 0;
+    }
+    PWP_UINT32 *var = &batch.recs[batch.cnt * BcFaceBatch::RecSize];
+    // The cell's REST index (1..totalNumCells)
+    var[0] = adsData.restCell(data->owner.cellIndex) + 1; // cellID
+    // Convert from PW local face id to ADS local face id
+    var[1] = fixFace(eType, data->owner.cellFaceIndex);
+    // Get the domains ADS type id
+    var[2] = adsData.getCDtid(data->owner.domain);
+    if (BcFaceBatch::Size == ++batch.cnt) {
+        return flushBcFaces<Binary>(batch);
+    }
+    return 1;
+}
+
+
+template<bool Binary>
+PWP_UINT32 endCB(PWGM_ENDSTREAM_DATA *data)
+{
+    BcFaceBatch &batch = *((BcFaceBatch*)data->userData);
+    // write the last partial batch and end progress step
+    const bool ok = flushBcFaces<Binary>(batch);
+    return batch.rti.adsData->progress().endStep() && ok;
+}
+
+
+// PW local face vertices of each element type: vertex count followed by
+// the element's local vertex indices. Rows are in PWGM_ENUM_ELEMTYPE order
+// and faces are in PW local face order (the cellFaceIndex order).
+static constexpr PWP_UINT8
+PwElemFaces[PWGM_ELEMTYPE_SIZE][MaxElemFaces][1 + ADSFaceHash::MaxFaceVerts] = {
+    // BAR
+    { { 0 } },
+    // HEX
+    { { 4, 0, 3, 2, 1 }, { 4, 4, 5, 6, 7 }, { 4, 0, 1, 5, 4 },
+      { 4, 1, 2, 6, 5 }, { 4, 2, 3, 7, 6 }, { 4, 3, 0, 4, 7 } },
+    // QUAD
+    { { 0 } },
+    // TRI
+    { { 0 } },
+    // TET
+    { { 3, 0, 2, 1 }, { 3, 0, 1, 3 }, { 3, 1, 2, 3 }, { 3, 2, 0, 3 } },
+    // WEDGE
+    { { 3, 0, 1, 2 }, { 3, 3, 5, 4 }, { 4, 0, 1, 4, 3 }, { 4, 1, 2, 5, 4 },
+      { 4, 2, 0, 3, 5 } },
+    // PYRAMID
+    { { 4, 0, 3, 2, 1 }, { 3, 0, 1, 4 }, { 3, 1, 2, 4 }, { 3, 2, 3, 4 },
+      { 3, 3, 0, 4 } },
+    // POINT
+    { { 0 } },
+};
+
+
+// Fills the BC records (cellID, ADS face id, CD tid) of all domains in
+// domain order without PwModStreamFaces(). Worker threads hash every
+// domain element by its vertices and then look up every face of every
+// volume element. Returns false if aborted or if a face has no owner.
+static bool
+matchBcFaces(CAEP_RTITEM &rti, std::vector<PWP_UINT32> &recs)
+{
+    const ADSData &adsData = *rti.adsData;
+    const PWP_UINT32 faceCnt = adsData.getBoundaryFaceCount();
+    const PWP_UINT32 elemCnt = adsData.getElementCount();
+    const unsigned threads = adsData.getWriterThreads();
+    ADSProgress &progress = rti.adsData->progress();
+    auto incr = [&](PWP_UINT32 items) {
+        return progress.incr(items);
+    };
+
+    // first record of each domain
+    std::vector<PWP_UINT32> domRec(1, 0);
+    for (PWP_UINT32 i = 0; i < adsData.getBcCount(); ++i) {
+        domRec.push_back(domRec.back() + adsData.getBoundaryFaceCount(i));
+    }
+
+    recs.resize(size_t(faceCnt) * BcFaceBatch::RecSize);
+    ADSFaceHash faces(faceCnt);
+    // Set for each vertex used by a domain element. A volume element face
+    // with any other vertex cannot be a BC face, so most faces are rejected
+    // without a hash lookup.
+    std::vector<std::atomic<PWP_UINT8> > onBc(adsData.getVertexCount());
+    for (size_t i = 0; i < onBc.size(); ++i) {
+        onBc[i].store(0, std::memory_order_relaxed);
+    }
+    auto hashFaces = [&](PWP_UINT32 beg, PWP_UINT32 end) {
+        PWP_UINT32 dom = PWP_UINT32(std::upper_bound(domRec.begin(),
+            domRec.end(), beg) - domRec.begin()) - 1;
+        PWGM_HDOMAIN hDom = PwModEnumDomains(rti.model, dom);
+        PWGM_ELEMDATA eData;
+        ADSFaceHash::Key key;
+        for (PWP_UINT32 r = beg; r < end; ++r) {
+            while (r >= domRec[dom + 1]) {
+                hDom = PwModEnumDomains(rti.model, ++dom);
+            }
+            if (!PwElemDataMod(PwDomEnumElements(hDom, r - domRec[dom]),
+                    &eData)) {
+                return false;
+            }
+            for (PWP_UINT32 i = 0; i < eData.vertCnt; ++i) {
+                if (eData.index[i] >= onBc.size()) {
+                    return false;
+                }
+                onBc[eData.index[i]].store(1, std::memory_order_relaxed);
+            }
+            ADSFaceHash::makeKey(eData.index, eData.vertCnt, key);
+            faces.insert(r, key);
+            recs[size_t(r) * BcFaceBatch::RecSize + 2] =
+                adsData.getCDtid(hDom);
+        }
+        return true;
+    };
+    if (!adsParallelFor(faceCnt, MTChunkSize, threads, hashFaces, incr)) {
+        return false;
+    }
+
+    // Owner of each face packed as element index, type and PW face index.
+    // The lowest element wins if more than one element has the face.
+    const PWP_UINT64 NoOwner = ~PWP_UINT64(0);
+    std::vector<std::atomic<PWP_UINT64> > owners(faceCnt);
+    for (PWP_UINT32 r = 0; r < faceCnt; ++r) {
+        owners[r].store(NoOwner, std::memory_order_relaxed);
+    }
+    auto findOwners = [&](PWP_UINT32 beg, PWP_UINT32 end) {
+        PWGM_ELEMDATA eData;
+        ADSFaceHash::Key key;
+        PWP_UINT32 fv[ADSFaceHash::MaxFaceVerts];
+        for (PWP_UINT32 eNdx = beg; eNdx < end; ++eNdx) {
+            if (!PwElemDataMod(PwModEnumElements(rti.model, eNdx), &eData) ||
+                    PWP_UINT32(eData.type) >= PWGM_ELEMTYPE_SIZE) {
+                return false;
+            }
+            const PWP_UINT8 (*elemFaces)[1 + ADSFaceHash::MaxFaceVerts] =
+                PwElemFaces[eData.type];
+            for (PWP_UINT32 f = 0; f < MaxElemFaces && 0 != elemFaces[f][0];
+                    ++f) {
+                const PWP_UINT32 n = elemFaces[f][0];
+                PWP_UINT32 i = 0;
+                for (; i < n; ++i) {
+                    fv[i] = eData.index[elemFaces[f][i + 1]];
+                    if (fv[i] >= onBc.size() ||
+                            0 == onBc[fv[i]].load(std::memory_order_relaxed)) {
+                        break;
+                    }
+                }
+                if (i < n) {
+                    // not on a BC
+                    continue;
+                }
+                ADSFaceHash::makeKey(fv, n, key);
+                const PWP_UINT64 owner = (PWP_UINT64(eNdx) << 8) |
+                    (PWP_UINT64(eData.type) << 4) | f;
+                faces.find(key, [&](PWP_UINT32 r) {
+                    PWP_UINT64 cur = owners[r].load(std::memory_order_relaxed);
+                    while (owner < cur && !owners[r].compare_exchange_weak(cur,
+                        owner, std::memory_order_relaxed)) {
+                    }
+                });
+            }
+        }
+        return true;
+    };
+    if (!adsParallelFor(elemCnt, MTChunkSize, threads, findOwners, incr)) {
+        return false;
+    }
+
+    for (PWP_UINT32 r = 0; r < faceCnt; ++r) {
+        const PWP_UINT64 owner = owners[r].load(std::memory_order_relaxed);
+        if (NoOwner == owner) {
+            return false;
+        }
+        PWP_UINT32 *var = &recs[size_t(r) * BcFaceBatch::RecSize];
+        // The cell's REST index (1..totalNumCells)
+        var[0] = adsData.restCell(PWP_UINT32(owner >> 8)) + 1;
+        // Convert from PW local face id to ADS local face id
+        var[1] = fixFace(PWGM_ENUM_ELEMTYPE((owner >> 4) & 0xF),
+            PWP_UINT32(owner & 0xF));
+    }
+    return true;
+}
+
+
+// Runs matchBcFaces() as one progress step
+static bool
+hashBcFaces(CAEP_RTITEM &rti, std::vector<PWP_UINT32> &recs)
+{
+    ADSData &adsData = *rti.adsData;
+    const PWP_UINT32 faceCnt = adsData.getBoundaryFaceCount();
+    bool ret = false;
+    if (adsData.progress().beginStep(faceCnt + adsData.getElementCount())) {
+        ret = matchBcFaces(rti, recs);
+    }
+    adsData.progress().endStep();
+    if (ret) {
+        adsData.stats().addCounts(ADSStageStats::BcFaces, faceCnt,
+            2 * PWP_UINT64(faceCnt) + adsData.getElementCount());
+    }
+    return ret;
+}
+
+
+// Writes the BC section using matchBcFaces(). Returns false without
+// writing anything if a face has no owner.
+static bool
+writeBCFaceHash(CAEP_RTITEM &rti)
+{
+    ADSData &adsData = *rti.adsData;
+    const PWP_UINT32 faceCnt = adsData.getBoundaryFaceCount();
+    std::vector<PWP_UINT32> recs;
+    const bool ret = hashBcFaces(rti, recs);
+    if (ret) {
+        ADSWriteBuffer &wrBuf = *rti.wrBuf;
+        if (CAEPU_RT_ENC_BINARY(&rti)) {
+            writeIndices(rti, recs.data(), recs.size());
+        }
+        else {
+            const PWP_UINT32 *rec = recs.data();
+            for (PWP_UINT32 r = 0; r < faceCnt; ++r) {
+                writeRecordT<false, BcFaceBatch::RecSize>(wrBuf, rec);
+                rec += BcFaceBatch::RecSize;
+            }
+        }
+    }
+    return ret;
+}
+
+
+static bool
+writeBCSection(CAEP_RTITEM &rti)
+{
+    ADSStageStats &stats = rti.adsData->stats();
+    stats.begin(ADSStageStats::BcFaces, restBytes(rti));
+    if (rti.adsData->useFaceHashBc()) {
+        if (writeBCFaceHash(rti)) {
+            stats.end(ADSStageStats::BcFaces, restBytes(rti), 0, 0);
+            return true;
+        }
+        if (rti.adsData->progress().aborted()) {
+            stats.end(ADSStageStats::BcFaces, restBytes(rti), 0, 0);
+            return false;
+        }
+        caeuSendWarningMsg(&rti, "Some boundary faces have no owner cell in "
+            "the face hash. Using PwModStreamFaces().", 0);
+    }
+    PWGM_ENUM_FACEORDER order = PWGM_FACEORDER_BCGROUPSONLY;
+    const bool binary = CAEPU_RT_ENC_BINARY(&rti);
+    PWGM_FACESTREAMCB faceFunc = binary ? faceCB<true> : faceCB<false>;
+    PWGM_ENDSTREAMCB endFunc = binary ? endCB<true> : endCB<false>;
+    BcFaceBatch batch(rti);
+    const bool ret = (0 != PwModStreamFaces(rti.model, order, beginCB,
+        faceFunc, endFunc, &batch));
+    // beginCB() adds the face counts
+    stats.end(ADSStageStats::BcFaces, restBytes(rti), 0, 1);
+    return ret;
+}
+
+
+// Writes the BC section or, in an incremental export, copies it from the
+// previous REST file if its fingerprint is unchanged. The owner cells and
+// faces are not found. They are covered by the ModelRevision and
+// bcFaceSample().
+static bool
+writeBC(CAEP_RTITEM &rti)
+{
+    ADSData &adsData = *rti.adsData;
+    auto write = [&]() {
+        return writeBCSection(rti);
+    };
+    if (!adsData.useIncremental()) {
+        return write();
+    }
+    ADSHash64 hash(ADSRestManifest::BcFaces);
+    adsData.bcFaceFingerprint(hash);
+    ADSStageStats &stats = adsData.stats();
+    // writeBCSection() restarts the stage if the section is written
+    stats.begin(ADSStageStats::BcFaces, restBytes(rti));
+    bool reused = false;
+    PWP_UINT64 sampleCalls = 0;
+    const PWP_UINT64 sample = bcFaceSample(rti, sampleCalls);
+    bool ret = writeOrReuse(rti, ADSRestManifest::BcFaces, hash.value(),
+        sample, write, reused);
+    stats.addCounts(ADSStageStats::BcFaces, 0, sampleCalls);
+    if (reused) {
+        // the copy is the section's progress step
+        const PWP_UINT32 faceCnt = adsData.getBoundaryFaceCount();
+        ret = adsData.progress().beginStep(faceCnt) &&
+            adsData.progress().add(faceCnt) && ret;
+        ret = adsData.progress().endStep() && ret;
+        stats.end(ADSStageStats::BcFaces, restBytes(rti), faceCnt, 0);
+    }
+    return ret;
+}
+
+
+static bool
+exportBCVAL(const ADSData &adsData, FILE *fp)
+{
+    // Dump info comment header 
+    fputs(
+        "******************************************************************\n"
+        "*BOUNDARY TYPE    DEFINITION                                     *\n"
+        "*00                No value applied                              *\n"
+        "*01                Reserved                                      *\n"
+        "*02                Inflow                                        *\n"
+        "*03                Outflow                                       *\n"
+        "*04                Reserved                                      *\n"
+        "*05                Reserved                                      *\n"
+        "******************************************************************\n",
+        fp);
+
+    PWP_UINT32 domainCount = adsData.getBcCount();
+    fprintf(fp, "*NUMBER OF BOUNDARY CONDITIONS\n"
+                  "%12i\n", (int)domainCount);
+
+    for (PWP_UINT32 i = 0; i < domainCount; ++i) {
+        fputs("*BOUNDARY_TYPE BOUNDARY_NAME                        IFANG\n",
+              fp);
+        fprintf(fp, " %-14i%-37s%-12i\n", 0, adsData.getBcName(i), 0);
+        fputs("*           MLO           PTLO           TTLO          ALPHA"
+                    "           BETA\n"
+              "      0.0000000      0.0000000      0.0000000      0.0000000"
+                    "      0.0000000\n",
+              fp);
+    }
+    return 0 == ferror(fp);
+}
+
+
+static bool
+exportBCTYPE(const ADSData &adsData, FILE *fp)
+{
+    // Dump info comment header 
+    fputs(
+        "******************************************************************\n"
+        "***ADS BC NAME***********DESCRIPTION******************************\n"
+        "******************************************************************\n"
+        "*** XX_INTERNAL     --> 'INTERIOR'                             ***\n"
+        "*** XX_FLOWTAN      --> 'FLOW TANGENCY'                        ***\n"
+        "*** XX_INFLOW       --> 'UP-STREAM'                            ***\n"
+        "*** XX_OUTFLOW      --> 'DOWN-STREAM'                          ***\n"
+        "*** XX_FARFIELD     --> 'FARFIELD IN/OUT'                      ***\n"
+        "*** XX_NRINFLOW     --> 'CASCADE UP-STREAM'                    ***\n"
+        "*** XX_NROUTFLOW    --> 'CASCADE DOWN-STREAM'                  ***\n"
+        "*** XX_INVISCID     --> 'NO FLOW NORMAL TO THE SURFACE'        ***\n"
+        "*** XX_WALLF        --> 'WALL FUNCTION'                        ***\n"
+        "*** XX_WALLIQ       --> 'NON-SLIP WALL WITH Q INPUT'           ***\n"
+        "*** XX_WALLIA       --> 'NON-SLIP WALL Q = 0.0'                ***\n"
+        "*** XX_WALLIS       --> 'NON-SLIP WALL IN STATIONARY FRAME'    ***\n"
+        "*** XX_WALLFCHT     --> 'WALL FUNCTION'                        ***\n"
+        "*** XX_WALLIQCHT    --> 'NON-SLIP WALL WITH Q INPUT'           ***\n"
+        "*** XX_WALLIACHT    --> 'NON-SLIP WALL Q = 0.0'                ***\n"
+        "*** XX_WALLISCHT    --> 'NON-SLIP WALL IN STATIONARY FRAME'    ***\n"
+        "*** XX_NMLINFLOW    --> 'INLET FLOW NORMAL TO MESH'            ***\n"
+        "*** XX_PERIODIC     --> 'PERIODIC FACE'                        ***\n"
+        "*** XX_PERIODICSHDW --> 'PERIODIC SHADOW FACE'                 ***\n"
+        "*** XX_INTSCT       --> 'INTERSECTOR PERIODIC FACE'            ***\n"
+        "*** XX_INTSCTSHDW   --> 'INTERSECTOR PERIODIC SHADOW FACE'     ***\n"
+        "*** XX_ISOTHERMAL   --> 'CONSTANT T WALL FOR HEAT CONDUCTION'  ***\n"
+        "*** XX_ADIABATIC    --> 'ADIABATIC WALL FOR HEAT CONDUCTION'   ***\n"
+        "*** XX_FMVINFLOW    --> 'UPSTREAM WITH FLOATING MERIDIONAL V'  ***\n"
+        "******************************************************************\n"
+        "\n", fp);
+
+    PWP_UINT32 domainCount = adsData.getBcCount();
+    fprintf(fp, "*NUMBER OF BOUNDARY CONDITIONS\n"
+                  "%-12i\n", (int)domainCount);
+    for (PWP_UINT32 i = 0; i < domainCount; i++) {
+        fputs("*BC NUMBER,    CFX NAME,                           ADS NAME\n",
+            fp);
+        fprintf(fp, "%-15i%-36s%-12s\n", int(i + 1), adsData.getBcName(i),
+            adsData.getAdsBcName(i));
+    }
+    return 0 == ferror(fp);
+}
+
+
+PWP_BOOL
+runtimeCreate(CAEP_RTITEM *)
+{
+    PWP_BOOL ret = caeuAssignInfoValue("AllowedFileByteOrders", "LittleEndian",
+            true) &&
+        caeuPublishValueDefinition(attrTitle, PWP_VALTYPE_STRING, "", "RW",
+            "Case Name", "/^.+$/") &&
+        caeuPublishValueDefinition(attrWriteBufferMB, PWP_VALTYPE_UINT, "16",
+            "RW", "REST file write buffer size in MB", "1 4096") &&
+        caeuPublishValueDefinition(attrWriterThreads, PWP_VALTYPE_UINT, "1",
+            "RW", "Number of REST writer threads (0 = all cores)", "0 1024") &&
+        caeuPublishValueDefinition(attrOutputMode, PWP_VALTYPE_ENUM,
+            "Buffered", "RW", "How the binary REST file is written",
+            "Buffered|Mapped") &&
+        caeuPublishValueDefinition(attrStageStats, PWP_VALTYPE_ENUM, "Off",
+            "RW", "Report per-stage export timing and counts",
+            "Off|Messages|Json") &&
+        caeuPublishValueDefinition(attrBcFaceEngine, PWP_VALTYPE_ENUM,
+            "Stream", "RW", "How the boundary face owners are found",
+            "Stream|FaceHash");
+#if defined(ADS_USE_ZLIB)
+    // Only builds linked with zlib can compress the REST file
+    ret = ret && caeuPublishValueDefinition(attrCompression,
+        PWP_VALTYPE_ENUM, "None", "RW", "Compression of the REST file",
+        "None|Gzip");
+#endif
+    return ret &&
+        caeuPublishValueDefinition(attrIncrementalExport, PWP_VALTYPE_BOOL,
+            "false", "RW", "Copy unchanged REST sections from the previous "
+            "export", "false|true") &&
+        caeuPublishValueDefinition(attrModelRevision, PWP_VALTYPE_STRING, "",
+            "RW", "Grid revision. Change it whenever the grid changes.",
+            "/^.*$/") &&
+        caeuPublishValueDefinition(attrAsyncWrite, PWP_VALTYPE_BOOL, "true",
+            "RW", "Write the REST file on a separate I/O thread",
+            "false|true") &&
+        caeuPublishValueDefinition(attrVertexOrder, PWP_VALTYPE_ENUM,
+            "Native", "RW", "Order of the REST vertices", "Native|RCM") &&
+        caeuPublishValueDefinition(attrCellOrder, PWP_VALTYPE_ENUM,
+            "Native", "RW", "Order of the REST cells",
+            "Native|Morton|Hilbert") &&
+        caeuPublishValueDefinition(attrIndexWidth, PWP_VALTYPE_ENUM, "32bit",
+            "RW", "Width of the binary REST integers", "32bit|64bit") &&
+        caeuPublishValueDefinition(attrPartitions, PWP_VALTYPE_UINT, "1",
+            "RW", "Number of REST partition files", "1 4096") &&
+        caeuPublishValueDefinition(attrValidate, PWP_VALTYPE_BOOL, "false",
+            "RW", "Check the binary REST file against the model after "
+            "writing it", "false|true");
+}
+
+
+// Every binary REST section has a fixed record size. The exact file size is
+// known up front, so the file is preallocated and mapped. The vertex and
+// connectivity sections are filled in parallel at their computed offsets.
+static bool
+writeRestFileMapped(CAEP_RTITEM &rti)
+{
+    const size_t TitleSize = 80;
+    const size_t indexSize = rti.adsData->getIndexSize();
+    const size_t headerSize = TitleSize + 4 * 15 * indexSize;
+
+    PWP_UINT32 vertRecCnt;
+    if (!vertexRecordCount(rti, vertRecCnt)) {
+        CAEPU_RT_ABORT(&rti);
+        return false;
+    }
+    const PWP_UINT64 vertBytes = PWP_UINT64(rti.adsData->getVertexCount()) *
+        vertRecCnt * vertexValueSize(rti);
+    const PWP_UINT64 elemBytes = PWP_UINT64(rti.adsData->getElementCount()) *
+        PWGM_ELEMDATA_VERT_SIZE * indexSize;
+    const PWP_UINT64 bcBytes =
+        PWP_UINT64(rti.adsData->getBoundaryFaceCount()) * 3 * indexSize;
+
+    ADSMappedFile restFile;
+    if (!restFile.open(fileName(rti, "REST").c_str(),
+            headerSize + vertBytes + elemBytes + bcBytes)) {
+        caeuSendErrorMsg(&rti, "Could not create mapped REST file!", 0);
+        return false;
+    }
+
+    char *p = restFile.data();
+    ADSWriteBuffer hdrBuf(p, headerSize);
+    rti.wrBuf = &hdrBuf;
+    bool ret = writeTitle(rti) && writeHeader(rti) && hdrBuf.close() &&
+        (headerSize == hdrBuf.bytesWritten());
+    p += headerSize;
+
+    ret = ret && writeVerticesMapped(rti, p);
+    p += vertBytes;
+
+    ret = ret && writeConnectivityMapped(rti, p);
+    p += elemBytes;
+
+    if (ret) {
+        // Faces arrive one at a time from PwModStreamFaces()
+        ADSWriteBuffer bcBuf(p, size_t(bcBytes));
+        rti.wrBuf = &bcBuf;
+        ret = writeBC(rti) && bcBuf.close() &&
+            (bcBytes == bcBuf.bytesWritten());
+    }
+    rti.wrBuf = 0;
+
+    if (!restFile.close()) {
+        caeuSendErrorMsg(&rti, "Could not write REST file!", 0);
+        ret = false;
+    }
+    return ret && !CAEPU_RT_IS_ABORTED(&rti);
+}
+
+
+// Writes all REST sections through wrBuf and closes it. A failed write stops
+// the export at the next section.
+static bool
+writeRestSections(CAEP_RTITEM &rti, ADSWriteBuffer &wrBuf)
+{
+    rti.wrBuf = &wrBuf;
+    if (rti.adsData->useAsyncWrite()) {
+        wrBuf.enableAsync();
+    }
+    const bool ret = writeTitle(rti) && writeHeader(rti) &&
+        writeVertices(rti) && wrBuf.ok() && writeConnectivity(rti) &&
+        wrBuf.ok() && writeBC(rti);
+    const bool closed = wrBuf.close();
+    rti.wrBuf = 0;
+    if (!closed) {
+        caeuSendErrorMsg(&rti, "Could not write REST file!", 0);
+    }
+    return ret && closed;
+}
+
+
+#if defined(ADS_USE_ZLIB)
+// The REST data is compressed in blocks on the writer threads as the
+// sections are produced and written to REST.gz. The file is opened in binary
+// mode, so ASCII line endings are not translated.
+static bool
+writeRestFileGzip(CAEP_RTITEM &rti)
+{
+    bool ret = openFile(rti, "REST.gz", PWP_ENCODING_BINARY);
+    if (ret) {
+        ADSGzipWriter gz(rti.fp, rti.adsData->getWriterThreads());
+        {
+            ADSWriteBuffer wrBuf(&gz, rti.adsData->getWriteBufferSize());
+            ret = writeRestSections(rti, wrBuf);
+        }
+        if (!gz.close() && ret) {
+            caeuSendErrorMsg(&rti, "Could not write REST file!", 0);
+            ret = false;
+        }
+        closeFile(rti);
+    }
+    return ret && !CAEPU_RT_IS_ABORTED(&rti);
+}
+#endif
+
+
+static PWP_UINT64
+fileSize(FILE *fp)
+{
+#if defined(_WIN32)
+    return (0 == _fseeki64(fp, 0, SEEK_END)) ? PWP_UINT64(_ftelli64(fp)) : 0;
+#else
+    return (0 == fseeko(fp, 0, SEEK_END)) ? PWP_UINT64(ftello(fp)) : 0;
+#endif
+}
+
+
+// Moves the previous REST file aside and opens it if it has a valid
+// manifest. Returns 0 if there is nothing to reuse.
+static FILE *
+openPrevRestFile(CAEP_RTITEM &rti, const std::string &prevName)
+{
+    ADSRestManifest &prev = rti.adsData->prevManifest();
+    const std::string restName = fileName(rti, "REST");
+    FILE *fp = 0;
+    pwpFileDelete(prevName.c_str());
+    if (prev.read(fileName(rti, "REST.manifest").c_str()) &&
+            (0 == rename(restName.c_str(), prevName.c_str()))) {
+        fp = pwpFileOpen(prevName.c_str(), pwpRead | pwpBinary);
+        if (0 != fp && fileSize(fp) != prev.getFileSize()) {
+            // not the file the manifest describes
+            pwpFileClose(fp);
+            fp = 0;
+        }
+        if (0 == fp) {
+            // nothing will read it
+            pwpFileDelete(prevName.c_str());
+        }
+    }
+    return fp;
+}
+
+
+// Computes the RCM vertex order from the element vertices. The elements are
+// fetched on the writer threads. The order itself is found on this thread.
+static bool
+orderVertices(CAEP_RTITEM &rti)
+{
+    ADSData &adsData = *rti.adsData;
+    if (!adsData.useRcmOrder()) {
+        return true;
+    }
+    const PWP_UINT32 Stride = PWGM_ELEMDATA_VERT_SIZE;
+    const PWP_UINT32 elemCnt = adsData.getElementCount();
+    const PWP_UINT32 vertCnt = adsData.getVertexCount();
+    std::vector<PWP_UINT32> elemVerts(size_t(elemCnt) * Stride);
+    std::vector<PWP_UINT8> elemVertCnts(elemCnt);
+    auto work = [&](PWP_UINT32 beg, PWP_UINT32 end) {
+        PWGM_ELEMDATA eData;
+        for (PWP_UINT32 eNdx = beg; eNdx < end; ++eNdx) {
+            if (!PwElemDataMod(PwModEnumElements(rti.model, eNdx), &eData)) {
+                return false;
+            }
+            elemVertCnts[eNdx] = PWP_UINT8(eData.vertCnt);
+            memcpy(&elemVerts[size_t(eNdx) * Stride], eData.index,
+                eData.vertCnt * sizeof(PWP_UINT32));
+        }
+        return true;
+    };
+    auto progress = [&](PWP_UINT32 items) {
+        return adsData.progress().incr(items);
+    };
+    bool ret = false;
+    ADSStageStats &stats = adsData.stats();
+    stats.begin(ADSStageStats::VertexOrder);
+    if (adsData.progress().beginStep(elemCnt)) {
+        ret = adsParallelFor(elemCnt, MTChunkSize,
+            adsData.getWriterThreads(), work, progress);
+    }
+    std::vector<PWP_UINT32> newToOld;
+    if (ret) {
+        ADSVertexOrder order(vertCnt, Stride, elemVerts, elemVertCnts);
+        ret = order.rcm(newToOld);
+        if (!ret) {
+            caeuSendErrorMsg(&rti, "Could not compute the RCM vertex order!",
+                0);
+        }
+    }
+    if (ret) {
+        adsData.setVertexOrder(newToOld);
+    }
+    adsData.progress().endStep();
+    stats.end(ADSStageStats::VertexOrder, 0, vertCnt, 2 * PWP_UINT64(elemCnt));
+    return ret && !adsData.progress().aborted();
+}
+
+
+// Fetches the XYZ of every vertex in model order on the writer threads and
+// sets lo and hi to their bounding box. Makes one progress increment per
+// vertex.
+static bool
+fetchVertexXYZ(CAEP_RTITEM &rti, std::vector<float> &xyz, float lo[3],
+    float hi[3])
+{
+    ADSData &adsData = *rti.adsData;
+    const PWP_UINT32 vertCnt = adsData.getVertexCount();
+    auto progress = [&](PWP_UINT32 items) {
+        return adsData.progress().incr(items);
+    };
+
+    // the bounding box of each chunk of vertices
+    const PWP_UINT32 chunkCnt = adsChunkCount(vertCnt, MTChunkSize);
+    xyz.resize(size_t(vertCnt) * 3);
+    std::vector<float> boxes(size_t(chunkCnt) * 6);
+    auto fetchVerts = [&](PWP_UINT32 beg, PWP_UINT32 end) {
+        float *box = &boxes[size_t(beg / MTChunkSize) * 6];
+        PWGM_VERTDATA v;
+        for (PWP_UINT32 vNdx = beg; vNdx < end; ++vNdx) {
+            if (!PwVertDataMod(PwModEnumVertices(rti.model, vNdx), &v)) {
+                return false;
+            }
+            float *p = &xyz[size_t(vNdx) * 3];
+            p[0] = float(v.x);
+            p[1] = float(v.y);
+            p[2] = float(v.z);
+            for (int i = 0; i < 3; ++i) {
+                if (vNdx == beg || p[i] < box[i]) {
+                    box[i] = p[i];
+                }
+                if (vNdx == beg || p[i] > box[i + 3]) {
+                    box[i + 3] = p[i];
+                }
+            }
+        }
+        return true;
+    };
+    const bool ret = adsParallelFor(vertCnt, MTChunkSize,
+        adsData.getWriterThreads(), fetchVerts, progress);
+
+    for (int i = 0; i < 3; ++i) {
+        lo[i] = hi[i] = 0.0f;
+    }
+    if (ret && 0 != chunkCnt) {
+        for (int i = 0; i < 3; ++i) {
+            lo[i] = boxes[i];
+            hi[i] = boxes[i + 3];
+        }
+        for (PWP_UINT32 c = 1; c < chunkCnt; ++c) {
+            for (int i = 0; i < 3; ++i) {
+                lo[i] = std::min(lo[i], boxes[size_t(c) * 6 + i]);
+                hi[i] = std::max(hi[i], boxes[size_t(c) * 6 + i + 3]);
+            }
+        }
+    }
+    return ret;
+}
+
+
+// Sets c to the centroid of eData. xyz holds the vertex XYZ loaded by
+// fetchVertexXYZ(). Returns false if an element vertex is out of range.
+static inline bool
+elemCentroid(const PWGM_ELEMDATA &eData, const std::vector<float> &xyz,
+    double c[3])
+{
+    const size_t vertCnt = xyz.size() / 3;
+    c[0] = c[1] = c[2] = 0.0;
+    for (PWP_UINT32 j = 0; j < eData.vertCnt; ++j) {
+        if (eData.index[j] >= vertCnt) {
+            return false;
+        }
+        const float *p = &xyz[size_t(eData.index[j]) * 3];
+        c[0] += p[0];
+        c[1] += p[1];
+        c[2] += p[2];
+    }
+    for (int i = 0; i < 3; ++i) {
+        c[i] /= eData.vertCnt;
+    }
+    return true;
+}
+
+
+// Sorts the cells of each block along a Morton or Hilbert curve of their
+// centroids. The blocks keep their order. The vertex XYZ are fetched once,
+// then the element centroids are keyed and radix sorted on the writer
+// threads.
+static bool
+orderCells(CAEP_RTITEM &rti)
+{
+    ADSData &adsData = *rti.adsData;
+    const ADSData::CellOrder cellOrder = adsData.getCellOrder();
+    if (ADSData::NativeCells == cellOrder) {
+        return true;
+    }
+    const PWP_UINT32 vertCnt = adsData.getVertexCount();
+    const PWP_UINT32 elemCnt = adsData.getElementCount();
+    const unsigned threads = adsData.getWriterThreads();
+    auto progress = [&](PWP_UINT32 items) {
+        return adsData.progress().incr(items);
+    };
+    ADSStageStats &stats = adsData.stats();
+    stats.begin(ADSStageStats::CellOrder);
+    if (!adsData.progress().beginStep(PWP_UINT64(vertCnt) + elemCnt)) {
+        adsData.progress().endStep();
+        return false;
+    }
+
+    std::vector<float> xyz;
+    float lo[3];
+    float hi[3];
+    bool ret = fetchVertexXYZ(rti, xyz, lo, hi);
+
+    // One scale for all axes so the curve cells are cubes
+    double scale = 0.0;
+    const double extent = std::max(double(hi[0]) - lo[0],
+        std::max(double(hi[1]) - lo[1], double(hi[2]) - lo[2]));
+    if (extent > 0.0) {
+        scale = double((PWP_UINT32(1) << AdsCurveBits) - 1) / extent;
+    }
+
+    std::vector<PWP_UINT64> keys(elemCnt);
+    std::vector<PWP_UINT32> newToOld(elemCnt);
+    const double maxCoord = double((PWP_UINT32(1) << AdsCurveBits) - 1);
+    auto keyElems = [&](PWP_UINT32 beg, PWP_UINT32 end) {
+        PWGM_ELEMDATA eData;
+        double c[3];
+        PWP_UINT32 q[3];
+        for (PWP_UINT32 eNdx = beg; eNdx < end; ++eNdx) {
+            if (!PwElemDataMod(PwModEnumElements(rti.model, eNdx), &eData) ||
+                    !elemCentroid(eData, xyz, c)) {
+                return false;
+            }
+            for (int i = 0; i < 3; ++i) {
+                const double t = (c[i] - lo[i]) * scale;
+                q[i] = PWP_UINT32(std::min(std::max(t, 0.0), maxCoord));
+            }
+            keys[eNdx] = (ADSData::HilbertCells == cellOrder) ?
+                adsHilbertKey(q[0], q[1], q[2]) :
+                adsMortonKey(q[0], q[1], q[2]);
+            newToOld[eNdx] = eNdx;
+        }
+        return true;
+    };
+    ret = ret && adsParallelFor(elemCnt, MTChunkSize, threads, keyElems,
+        progress);
+
+    if (ret) {
+        // ADS blocks are contiguous runs of cells. Sort within each block.
+        PWP_UINT32 beg = 0;
+        for (PWP_UINT32 b = 0; b < adsData.getBlockCount(); ++b) {
+            const PWP_UINT32 end = beg + adsData.getBlockElementCount(b);
+            adsRadixSort(keys, newToOld, beg, std::min(end, elemCnt),
+                threads);
+            beg = end;
+        }
+        adsData.setCellOrder(newToOld);
+    }
+    adsData.progress().endStep();
+    stats.end(ADSStageStats::CellOrder, 0, elemCnt,
+        2 * (PWP_UINT64(vertCnt) + elemCnt));
+    return ret && !adsData.progress().aborted();
+}
+
+
+// Cells, boundary faces and vertices of each REST partition file. The items
+// of partition k are at [cellStart[k], cellStart[k + 1]) of cells and at
+// [bcStart[k], bcStart[k + 1]) of the bcRecs records.
+struct RestPartitions {
+    typedef std::vector<PWP_UINT32> UINT32Vec;
+
+    RestPartitions(PWP_UINT32 count) :
+        count(count),
+        cellPart(),
+        cellLocal(),
+        cellStart(count + 1, 0),
+        cells(),
+        bcStart(count + 1, 0),
+        bcRecs(),
+        verts(count),
+        vertUseCnt(),
+        sharedStart(),
+        sharedUses(),
+        bytes(count, 0)
+    {
+    }
+
+    // Number of partitions
+    PWP_UINT32  count;
+
+    // Partition and local index of each cell in REST order
+    UINT32Vec   cellPart;
+    UINT32Vec   cellLocal;
+
+    // REST index of the cells of each partition in increasing order
+    UINT32Vec   cellStart;
+    UINT32Vec   cells;
+
+    // BC face records (local cellID, face, tid) of each partition
+    UINT32Vec   bcStart;
+    UINT32Vec   bcRecs;
+
+    // 1-based REST index of the vertices used by each partition in
+    // increasing order. The position in the list is the local index.
+    std::vector<UINT32Vec> verts;
+
+    // Number of partitions that use each vertex in REST order
+    UINT32Vec   vertUseCnt;
+
+    // The uses of vertex v by more than one partition are at
+    // [sharedStart[v], sharedStart[v + 1]) of sharedUses. Each use is a
+    // partition and the vertex's local index in it.
+    UINT32Vec   sharedStart;
+    UINT32Vec   sharedUses;
 
+    // Number of bytes written to the files of each partition
+    std::vector<PWP_UINT64> bytes;
+};
+
+
+// Name of the file with extension ext of partition k. The partitions are
+// numbered from 1 in the file names.
+static std::string
+partitionFileName(CAEP_RTITEM &rti, PWP_UINT32 k, const char *ext)
+{
+    std::ostringstream name;
+    name << "P" << (k + 1) << "." << ext;
+    return fileName(rti, name.str().c_str());
+}
+
+
+// Appends recCnt records of recSize integers to wrBuf in the REST encoding.
+// Binary integers are written with 64 bits if wide is true.
+static void
+writeIndexRecords(ADSWriteBuffer &wrBuf, bool binary, bool wide,
+    const PWP_UINT32 *var, size_t recCnt, PWP_UINT32 recSize, int fldWd = 1)
+{
+    if (binary) {
+        writeIndices(wrBuf, wide, var, recCnt * recSize);
+        return;
+    }
+    for (size_t i = 0; i < recCnt; ++i) {
+        writeRecordT<false, 0>(wrBuf, var, recSize, fldWd);
+        var += recSize;
+    }
+}
+
+
+// Assigns the REST cells to partitions by recursive coordinate bisection of
+// their centroids and groups them by partition. The cells of a partition
+// keep their REST order. Also fills the cell type cache for faceCB().
 static bool
-exportBCVAL(CAEP_RTITEM &rti)
+partitionCells(CAEP_RTITEM &rti, RestPartitions &parts)
 {
-    // Dump info comment header 
-    fputs(
-        "******************************************************************\n"
-        "*BOUNDARY TYPE    DEFINITION                                     *\n"
-        "*00                No value applied                              *\n"
-        "*01                Reserved                                      *\n"
-        "*02                Inflow                                        *\n"
-        "*03                Outflow                                       *\n"
-        "*04                Reserved                                      *\n"
-        "*05                Reserved                                      *\n"
-        "******************************************************************\n",
-        rti.fp);
+    ADSData &adsData = *rti.adsData;
+    const PWP_UINT32 vertCnt = adsData.getVertexCount();
+    const PWP_UINT32 elemCnt = adsData.getElementCount();
+    auto progress = [&](PWP_UINT32 items) {
+        return adsData.progress().incr(items);
+    };
+    ADSStageStats &stats = adsData.stats();
+    stats.begin(ADSStageStats::Partition);
+    if (!adsData.progress().beginStep(PWP_UINT64(vertCnt) + elemCnt)) {
+        adsData.progress().endStep();
+        return false;
+    }
 
-    PWP_UINT32 domainCount = PwModDomainCount(rti.model);
-    fprintf(rti.fp, "*NUMBER OF BOUNDARY CONDITIONS\n"
-                      "%12i\n", (int)domainCount);
+    std::vector<float> xyz;
+    float lo[3];
+    float hi[3];
+    bool ret = fetchVertexXYZ(rti, xyz, lo, hi);
 
-    bool ret = true;
-    PWGM_CONDDATA bc;
-    for (PWP_UINT32 i = 0; i < domainCount; ++i) {
-        if (!GetBcData(rti, i, bc)) {
-            ret = false;
+    std::vector<float> centroids(size_t(elemCnt) * 3);
+    adsData.initCellTypes();
+    auto centroidElems = [&](PWP_UINT32 beg, PWP_UINT32 end) {
+        PWGM_ELEMDATA eData;
+        double c[3];
+        for (PWP_UINT32 r = beg; r < end; ++r) {
+            const PWP_UINT32 eNdx = adsData.modelCell(r);
+            if (!PwElemDataMod(PwModEnumElements(rti.model, eNdx), &eData) ||
+                    !elemCentroid(eData, xyz, c)) {
+                return false;
+            }
+            adsData.setCellType(eNdx, eData.type);
+            float *p = &centroids[size_t(r) * 3];
+            p[0] = float(c[0]);
+            p[1] = float(c[1]);
+            p[2] = float(c[2]);
+        }
+        return true;
+    };
+    ret = ret && adsParallelFor(elemCnt, MTChunkSize,
+        adsData.getWriterThreads(), centroidElems, progress);
+
+    if (ret) {
+        xyz.clear();
+        ADSPartition(centroids).rcb(parts.count, parts.cellPart);
+        // counting sort by partition
+        for (PWP_UINT32 r = 0; r < elemCnt; ++r) {
+            ++parts.cellStart[parts.cellPart[r] + 1];
+        }
+        for (PWP_UINT32 k = 0; k < parts.count; ++k) {
+            parts.cellStart[k + 1] += parts.cellStart[k];
+        }
+        std::vector<PWP_UINT32> next(parts.cellStart.begin(),
+            parts.cellStart.end() - 1);
+        parts.cells.resize(elemCnt);
+        parts.cellLocal.resize(elemCnt);
+        for (PWP_UINT32 r = 0; r < elemCnt; ++r) {
+            const PWP_UINT32 k = parts.cellPart[r];
+            parts.cellLocal[r] = next[k] - parts.cellStart[k];
+            parts.cells[next[k]++] = r;
         }
-        fputs("*BOUNDARY_TYPE BOUNDARY_NAME                        IFANG\n",
-              rti.fp);
-        fprintf(rti.fp, " %-14i%-37s%-12i\n", 0, bc.name, 0);
-        fputs("*           MLO           PTLO           TTLO          ALPHA"
-                    "           BETA\n"
-              "      0.0000000      0.0000000      0.0000000      0.0000000"
-                    "      0.0000000\n",
-              rti.fp);
     }
-    return ret;
+    adsData.progress().endStep();
+    stats.end(ADSStageStats::Partition, 0, elemCnt,
+        PWP_UINT64(vertCnt) + 2 * PWP_UINT64(elemCnt));
+    return ret && !adsData.progress().aborted();
 }
 
 
+// Loads the BC face records of the whole model into recs in REST order. One
+// progress step.
 static bool
-exportBCTYPE(CAEP_RTITEM &rti)
+collectBcFaces(CAEP_RTITEM &rti, std::vector<PWP_UINT32> &recs)
 {
-    // Dump info comment header 
-    fputs(
-        "******************************************************************\n"
-        "***ADS BC NAME***********DESCRIPTION******************************\n"
-        "******************************************************************\n"
-        "*** XX_INTERNAL     --> 'INTERIOR'                             ***\n"
-        "*** XX_FLOWTAN      --> 'FLOW TANGENCY'                        ***\n"
-        "*** XX_INFLOW       --> 'UP-STREAM'                            ***\n"
-        "*** XX_OUTFLOW      --> 'DOWN-STREAM'                          ***\n"
-        "*** XX_FARFIELD     --> 'FARFIELD IN/OUT'                      ***\n"
-        "*** XX_NRINFLOW     --> 'CASCADE UP-STREAM'                    ***\n"
-        "*** XX_NROUTFLOW    --> 'CASCADE DOWN-STREAM'                  ***\n"
-        "*** XX_INVISCID     --> 'NO FLOW NORMAL TO THE SURFACE'        ***\n"
-        "*** XX_WALLF        --> 'WALL FUNCTION'                        ***\n"
-        "*** XX_WALLIQ       --> 'NON-SLIP WALL WITH Q INPUT'           ***\n"
-        "*** XX_WALLIA       --> 'NON-SLIP WALL Q = 0.0'                ***\n"
-        "*** XX_WALLIS       --> 'NON-SLIP WALL IN STATIONARY FRAME'    ***\n"
-        "*** XX_WALLFCHT     --> 'WALL FUNCTION'                        ***\n"
-        "*** XX_WALLIQCHT    --> 'NON-SLIP WALL WITH Q INPUT'           ***\n"
-        "*** XX_WALLIACHT    --> 'NON-SLIP WALL Q = 0.0'                ***\n"
-        "*** XX_WALLISCHT    --> 'NON-SLIP WALL IN STATIONARY FRAME'    ***\n"
-        "*** XX_NMLINFLOW    --> 'INLET FLOW NORMAL TO MESH'            ***\n"
-        "*** XX_PERIODIC     --> 'PERIODIC FACE'                        ***\n"
-        "*** XX_PERIODICSHDW --> 'PERIODIC SHADOW FACE'                 ***\n"
-        "*** XX_INTSCT       --> 'INTERSECTOR PERIODIC FACE'            ***\n"
-        "*** XX_INTSCTSHDW   --> 'INTERSECTOR PERIODIC SHADOW FACE'     ***\n"
-        "*** XX_ISOTHERMAL   --> 'CONSTANT T WALL FOR HEAT CONDUCTION'  ***\n"
-        "*** XX_ADIABATIC    --> 'ADIABATIC WALL FOR HEAT CONDUCTION'   ***\n"
-        "*** XX_FMVINFLOW    --> 'UPSTREAM WITH FLOATING MERIDIONAL V'  ***\n"
-        "******************************************************************\n"
-        "\n", rti.fp);
+    ADSData &adsData = *rti.adsData;
+    ADSStageStats &stats = adsData.stats();
+    stats.begin(ADSStageStats::BcFaces);
+    bool ret = false;
+    bool hashed = false;
+    if (adsData.useFaceHashBc()) {
+        ret = hashed = hashBcFaces(rti, recs);
+        if (!ret && !adsData.progress().aborted()) {
+            caeuSendWarningMsg(&rti, "Some boundary faces have no owner cell "
+                "in the face hash. Using PwModStreamFaces().", 0);
+        }
+    }
+    if (!ret && !adsData.progress().aborted()) {
+        BcFaceBatch batch(rti);
+        batch.out = &recs;
+        recs.clear();
+        recs.reserve(size_t(adsData.getBoundaryFaceCount()) *
+            BcFaceBatch::RecSize);
+        ret = (0 != PwModStreamFaces(rti.model, PWGM_FACEORDER_BCGROUPSONLY,
+            beginCB, faceCB<true>, endCB<true>, &batch));
+    }
+    // hashBcFaces() and beginCB() add the face counts
+    stats.end(ADSStageStats::BcFaces, 0, 0, hashed ? 0 : 1);
+    return ret && !adsData.progress().aborted();
+}
 
-    bool ret = true; // assume all is okay
-    PWP_UINT32 domainCount = PwModDomainCount(rti.model);
-    fprintf(rti.fp, "*NUMBER OF BOUNDARY CONDITIONS\n"
-                      "%-12i\n", (int)domainCount);
-    PWGM_CONDDATA bc;
-    for (PWP_UINT32 i = 0; i < domainCount; i++) {
-        if (!GetBcData(rti, i, bc)) {
-            ret = false;
+
+// Groups the BC face records by the partition of their cell and converts
+// their cellIDs to local cellIDs. The faces of a partition keep their order.
+static void
+splitBcFaces(RestPartitions &parts, const std::vector<PWP_UINT32> &recs)
+{
+    const size_t RecSize = BcFaceBatch::RecSize;
+    const size_t faceCnt = recs.size() / RecSize;
+    for (size_t f = 0; f < faceCnt; ++f) {
+        ++parts.bcStart[parts.cellPart[recs[f * RecSize] - 1] + 1];
+    }
+    for (PWP_UINT32 k = 0; k < parts.count; ++k) {
+        parts.bcStart[k + 1] += parts.bcStart[k];
+    }
+    std::vector<PWP_UINT32> next(parts.bcStart.begin(),
+        parts.bcStart.end() - 1);
+    parts.bcRecs.resize(recs.size());
+    for (size_t f = 0; f < faceCnt; ++f) {
+        const PWP_UINT32 *rec = &recs[f * RecSize];
+        const PWP_UINT32 k = parts.cellPart[rec[0] - 1];
+        PWP_UINT32 *var = &parts.bcRecs[size_t(next[k]++) * RecSize];
+        var[0] = parts.cellLocal[rec[0] - 1] + 1; // local cellID
+        var[1] = rec[1];
+        var[2] = rec[2];
+    }
+}
+
+
+// Writes the header records of a partition file. The layout is the same as
+// writeHeader(). NSECTIONS is the number of partitions and the counts are
+// the partition's.
+static void
+writePartitionHeader(CAEP_RTITEM &rti, ADSWriteBuffer &wrBuf,
+    PWP_UINT32 nnl, PWP_UINT32 nel, PWP_UINT32 nbcl)
+{
+    const ADSData &adsData = *rti.adsData;
+    const PWP_UINT32 VARSZ = 15;
+    PWP_UINT32 var[4][VARSZ] = { { 0 } };
+    var[0][0] = adsData.getPartitionCount(); // NSECTIONS
+    var[0][2] = adsData.getNDVAR(); // NDVAR
+    var[0][6] = adsData.getBlockCount(); // NBK
+    var[2][0] = nnl; // NNL
+    var[2][1] = nel; // NEL
+    var[2][2] = nbcl; // NBCL
+    var[2][4] = adsData.getNDVAR(); // NCDUT
+    writeIndexRecords(wrBuf, 0 != CAEPU_RT_ENC_BINARY(&rti),
+        adsData.useWideIndices(), var[0], 4, VARSZ);
+}
+
+
+// Writes the REST file of partition k. The vertices are the ones used by
+// the partition's cells and all indices are local. Runs on a writer thread,
+// so it only reads the shared data and makes no caeu*() calls.
+template<typename Real>
+static bool
+writePartitionRest(CAEP_RTITEM &rti, RestPartitions &parts, PWP_UINT32 k,
+    const std::string &title)
+{
+    ADSData &adsData = *rti.adsData;
+    const PWP_UINT32 Stride = PWGM_ELEMDATA_VERT_SIZE;
+    const PWP_UINT32 *cells = parts.cells.data() + parts.cellStart[k];
+    const PWP_UINT32 cellCnt = parts.cellStart[k + 1] - parts.cellStart[k];
+
+    // connectivity in REST vertex indices
+    std::vector<PWP_UINT32> conn(size_t(cellCnt) * Stride);
+    PWGM_ELEMDATA eData;
+    for (PWP_UINT32 i = 0; i < cellCnt; ++i) {
+        if ((0 == i % MTChunkSize && adsData.progress().aborted()) ||
+                !PwElemDataMod(PwModEnumElements(rti.model,
+                    adsData.modelCell(cells[i])), &eData)) {
+            return false;
         }
-        fputs("*BC NUMBER,    CFX NAME,                           ADS NAME\n",
-            rti.fp);
-        fprintf(rti.fp, "%-15i%-36s%-12s\n", int(i + 1), bc.name,
-            rti.adsData->getAdsBcName(i));
+        elemIndices(adsData, eData, &conn[size_t(i) * Stride]);
     }
-    return ret;
+
+    // number the used vertices in REST order and switch to local indices
+    std::vector<PWP_UINT32> &verts = parts.verts[k];
+    ADSLocalNumbering().number(conn, verts);
+
+    Real var[MaxVertRecord];
+    PWP_UINT32 count;
+    const bool binary = (0 != CAEPU_RT_ENC_BINARY(&rti));
+    const bool wide = adsData.useWideIndices();
+    FILE *fp = pwpFileOpen(partitionFileName(rti, k, "REST").c_str(),
+        pwpWrite | (binary ? pwpBinary : pwpAscii));
+    if (0 == fp || !initVertexRecord(rti, var, count)) {
+        if (0 != fp) {
+            pwpFileClose(fp);
+        }
+        return false;
+    }
+    const PWP_UINT32 bcCnt = parts.bcStart[k + 1] - parts.bcStart[k];
+    bool ret = true;
+    {
+        ADSWriteBuffer wrBuf(fp, adsData.getWriteBufferSize());
+        wrBuf.write(title.data(), title.size());
+        writePartitionHeader(rti, wrBuf, PWP_UINT32(verts.size()), cellCnt,
+            bcCnt);
+        PWGM_VERTDATA v;
+        for (size_t l = 0; l < verts.size(); ++l) {
+            if (!PwVertDataMod(PwModEnumVertices(rti.model,
+                    adsData.modelVertex(verts[l] - 1)), &v)) {
+                ret = false;
+                break;
+            }
+            setVertexXYZ(var, v);
+            if (binary) {
+                writeRecordT<true, 0>(wrBuf, var, count);
+            }
+            else {
+                writeRecordT<false, 0>(wrBuf, var, count);
+            }
+        }
+        writeIndexRecords(wrBuf, binary, wide, conn.data(), cellCnt, Stride,
+            5);
+        writeIndexRecords(wrBuf, binary, wide,
+            parts.bcRecs.data() + size_t(parts.bcStart[k]) *
+                BcFaceBatch::RecSize,
+            bcCnt, BcFaceBatch::RecSize);
+        ret = wrBuf.close() && ret;
+        parts.bytes[k] += wrBuf.bytesWritten();
+    }
+    return (0 == pwpFileClose(fp)) && ret;
 }
 
 
-PWP_BOOL
-runtimeCreate(CAEP_RTITEM *)
+// Finds the vertices used by more than one partition. Needs the vertex
+// lists of all partitions.
+static void
+findSharedVertices(RestPartitions &parts, PWP_UINT32 vertCnt)
 {
-    return caeuAssignInfoValue("AllowedFileByteOrders", "LittleEndian", true) &&
-        caeuPublishValueDefinition(attrTitle, PWP_VALTYPE_STRING, "", "RW",
-            "Case Name", "/^.+$/");
+    parts.vertUseCnt.assign(vertCnt, 0);
+    for (PWP_UINT32 k = 0; k < parts.count; ++k) {
+        const std::vector<PWP_UINT32> &verts = parts.verts[k];
+        for (size_t l = 0; l < verts.size(); ++l) {
+            ++parts.vertUseCnt[verts[l] - 1];
+        }
+    }
+    std::vector<PWP_UINT32> &start = parts.sharedStart;
+    start.assign(size_t(vertCnt) + 1, 0);
+    for (PWP_UINT32 v = 0; v < vertCnt; ++v) {
+        const PWP_UINT32 cnt = parts.vertUseCnt[v];
+        start[v + 1] = start[v] + (cnt > 1 ? cnt : 0);
+    }
+    parts.sharedUses.resize(2 * size_t(start[vertCnt]));
+    // start[v] is used as the fill position of vertex v and then shifted
+    // back into place
+    for (PWP_UINT32 k = 0; k < parts.count; ++k) {
+        const std::vector<PWP_UINT32> &verts = parts.verts[k];
+        for (size_t l = 0; l < verts.size(); ++l) {
+            const PWP_UINT32 v = verts[l] - 1;
+            if (parts.vertUseCnt[v] > 1) {
+                PWP_UINT32 *use = &parts.sharedUses[2 * size_t(start[v]++)];
+                use[0] = k;
+                use[1] = PWP_UINT32(l);
+            }
+        }
+    }
+    for (PWP_UINT32 v = vertCnt; v > 1; --v) {
+        start[v - 1] = start[v - 2];
+    }
+    if (0 != vertCnt) {
+        start[0] = 0;
+    }
 }
 
 
+// Writes the map file of partition k. It has the same encoding and integer
+// width as the REST files. The records are:
+//   partition count, partition number, NNL, NEL, interface count
+//   NNL records: global REST vertex number of each local vertex
+//   NEL records: global REST cell number of each local cell
+//   interface records: local vertex number, neighbor partition number and
+//     the vertex's local number in the neighbor partition
+// All numbers are 1-based. Runs on a writer thread.
 static bool
-writeRestFile(CAEP_RTITEM &rti)
+writePartitionMap(CAEP_RTITEM &rti, RestPartitions &parts, PWP_UINT32 k)
 {
-    bool ret = openFile(rti, "REST", rti.pWriteInfo->encoding);
+    const ADSData &adsData = *rti.adsData;
+    const std::vector<PWP_UINT32> &verts = parts.verts[k];
+    const PWP_UINT32 cellCnt = parts.cellStart[k + 1] - parts.cellStart[k];
+
+    std::vector<PWP_UINT32> ifRecs;
+    for (size_t l = 0; l < verts.size(); ++l) {
+        const PWP_UINT32 v = verts[l] - 1;
+        if (parts.vertUseCnt[v] < 2) {
+            continue;
+        }
+        for (PWP_UINT32 u = parts.sharedStart[v];
+                u < parts.sharedStart[v + 1]; ++u) {
+            const PWP_UINT32 *use = &parts.sharedUses[2 * size_t(u)];
+            if (use[0] != k) {
+                ifRecs.push_back(PWP_UINT32(l) + 1);
+                ifRecs.push_back(use[0] + 1);
+                ifRecs.push_back(use[1] + 1);
+            }
+        }
+    }
+
+    const PWP_UINT32 *first = parts.cells.data() + parts.cellStart[k];
+    std::vector<PWP_UINT32> cells(first, first + cellCnt);
+    for (size_t i = 0; i < cells.size(); ++i) {
+        ++cells[i];
+    }
+
+    const bool binary = (0 != CAEPU_RT_ENC_BINARY(&rti));
+    const bool wide = adsData.useWideIndices();
+    FILE *fp = pwpFileOpen(partitionFileName(rti, k, "MAP").c_str(),
+        pwpWrite | (binary ? pwpBinary : pwpAscii));
+    if (0 == fp) {
+        return false;
+    }
+    bool ret;
+    {
+        const PWP_UINT32 hdr[5] = { parts.count, k + 1,
+            PWP_UINT32(verts.size()), cellCnt, PWP_UINT32(ifRecs.size() / 3)
+        };
+        ADSWriteBuffer wrBuf(fp, adsData.getWriteBufferSize());
+        writeIndexRecords(wrBuf, binary, wide, hdr, 1, 5);
+        writeIndexRecords(wrBuf, binary, wide, verts.data(), verts.size(),
+            1);
+        writeIndexRecords(wrBuf, binary, wide, cells.data(), cells.size(),
+            1);
+        writeIndexRecords(wrBuf, binary, wide, ifRecs.data(),
+            ifRecs.size() / 3, 3);
+        ret = wrBuf.close();
+        parts.bytes[k] += wrBuf.bytesWritten();
+    }
+    return (0 == pwpFileClose(fp)) && ret;
+}
+
+
+// Writes one REST file and one map file per partition in place of the REST
+// file. The partitions are written on the writer threads, one partition per
+// thread at a time.
+static bool
+writeRestPartitions(CAEP_RTITEM &rti)
+{
+    ADSData &adsData = *rti.adsData;
+    const PWP_UINT32 partCnt = adsData.getPartitionCount();
+    const unsigned threads = adsData.getWriterThreads();
+    RestPartitions parts(partCnt);
+    std::vector<PWP_UINT32> recs;
+    bool ret = partitionCells(rti, parts) && collectBcFaces(rti, recs);
     if (ret) {
-        ret = writeTitle(rti) && writeFirstLine(rti) && writeSecondLine(rti) &&
-            writeThirdLine(rti) && writeFourthLine(rti) &&
-            writeVertices(rti) && writeConnectivity(rti) && writeBC(rti);
-        closeFile(rti);
+        splitBcFaces(parts, recs);
+        std::vector<PWP_UINT32>().swap(recs);
+    }
+
+    ADSStageStats &stats = adsData.stats();
+    stats.begin(ADSStageStats::PartitionFiles);
+    const std::string title = titleRecord(rti);
+    const bool dbl = CAEPU_RT_PREC_DOUBLE(&rti);
+    auto writeRest = [&](PWP_UINT32 beg, PWP_UINT32 end) {
+        for (PWP_UINT32 k = beg; k < end; ++k) {
+            if (!(dbl ? writePartitionRest<double>(rti, parts, k, title) :
+                    writePartitionRest<float>(rti, parts, k, title))) {
+                return false;
+            }
+        }
+        return true;
+    };
+    auto writeMap = [&](PWP_UINT32 beg, PWP_UINT32 end) {
+        for (PWP_UINT32 k = beg; k < end; ++k) {
+            if (!writePartitionMap(rti, parts, k)) {
+                return false;
+            }
+        }
+        return true;
+    };
+    auto progress = [&](PWP_UINT32 items) {
+        return adsData.progress().incr(items);
+    };
+    if (ret) {
+        ret = adsData.progress().beginStep(partCnt) &&
+            adsParallelFor(partCnt, 1, threads, writeRest, progress);
+        adsData.progress().endStep();
+    }
+    if (ret) {
+        ret = adsData.progress().beginStep(partCnt);
+        if (ret) {
+            findSharedVertices(parts, adsData.getVertexCount());
+            ret = adsParallelFor(partCnt, 1, threads, writeMap, progress);
+        }
+        adsData.progress().endStep();
+    }
+    PWP_UINT64 bytes = 0;
+    PWP_UINT64 vertUses = 0;
+    for (PWP_UINT32 k = 0; k < partCnt; ++k) {
+        bytes += parts.bytes[k];
+        vertUses += parts.verts[k].size();
+    }
+    stats.end(ADSStageStats::PartitionFiles, bytes, partCnt,
+        adsData.getElementCount() + 2 * vertUses);
+
+    if (!ret) {
+        if (!adsData.progress().aborted()) {
+            caeuSendErrorMsg(&rti, "Could not write REST partition files!",
+                0);
+        }
+        // A failed or aborted export leaves no partition files behind
+        for (PWP_UINT32 k = 0; k < partCnt; ++k) {
+            pwpFileDelete(partitionFileName(rti, k, "REST").c_str());
+            pwpFileDelete(partitionFileName(rti, k, "MAP").c_str());
+        }
     }
     return ret && !CAEPU_RT_IS_ABORTED(&rti);
 }
 
 
 static bool
-writeBcValFile(CAEP_RTITEM &rti)
+writeRestFile(CAEP_RTITEM &rti)
 {
-    bool ret = openFile(rti, "BCVAL", PWP_ENCODING_ASCII);
+    ADSData &adsData = *rti.adsData;
+    if (!orderVertices(rti) || !orderCells(rti)) {
+        return false;
+    }
+    const std::string manifestName = fileName(rti, "REST.manifest");
+    const std::string prevName = fileName(rti, "REST.prev");
+    FILE *prevRest = 0;
+    if (adsData.useIncremental()) {
+        prevRest = openPrevRestFile(rti, prevName);
+        adsData.setPrevRestFile(prevRest);
+    }
+    // The manifest only describes a REST file written with it
+    pwpFileDelete(manifestName.c_str());
+
+    if (adsData.getPartitionCount() > 1) {
+        return writeRestPartitions(rti);
+    }
+    if (adsData.useMappedOutput()) {
+        return writeRestFileMapped(rti);
+    }
+#if defined(ADS_USE_ZLIB)
+    if (adsData.useGzipRest()) {
+        return writeRestFileGzip(rti);
+    }
+#endif
+    bool ret = openFile(rti, "REST", rti.pWriteInfo->encoding);
+    PWP_UINT64 restSize = 0;
     if (ret) {
-        ret = exportBCVAL(rti);
+        // All REST data is staged in wrBuf and written in large chunks
+        ADSWriteBuffer wrBuf(rti.fp, adsData.getWriteBufferSize());
+        ret = writeRestSections(rti, wrBuf);
+        restSize = wrBuf.bytesWritten();
         closeFile(rti);
     }
+    if (0 != prevRest) {
+        adsData.setPrevRestFile(0);
+        pwpFileClose(prevRest);
+        pwpFileDelete(prevName.c_str());
+    }
+    if (ret && adsData.useIncremental()) {
+        adsData.manifest().setFileSize(restSize);
+        if (!adsData.manifest().write(manifestName.c_str())) {
+            caeuSendWarningMsg(&rti, "Could not write REST manifest file!",
+                0);
+        }
+    }
     return ret && !CAEPU_RT_IS_ABORTED(&rti);
 }
 
 
+// Number of vertices of each element type. Rows are in PWGM_ENUM_ELEMTYPE
+// order.
+static constexpr PWP_UINT32 ElemVertCnts[PWGM_ELEMTYPE_SIZE] = {
+    2, 8, 4, 3, 4, 6, 5, 1
+};
+
+
+// Runs check(r) for every record r in [0, total) on the writer threads.
+// Returns the lowest r that fails or total if none does. Makes one progress
+// increment per record.
+template<typename CheckFunc>
+static PWP_UINT32
+findBadRecord(CAEP_RTITEM &rti, PWP_UINT32 total, CheckFunc check)
+{
+    ADSData &adsData = *rti.adsData;
+    std::atomic<PWP_UINT32> bad(total);
+    auto work = [&](PWP_UINT32 beg, PWP_UINT32 end) {
+        for (PWP_UINT32 r = beg; r < end; ++r) {
+            if (!check(r)) {
+                // keep the lowest bad record of all chunks
+                PWP_UINT32 cur = bad;
+                while (r < cur && !bad.compare_exchange_weak(cur, r)) {
+                }
+                break;
+            }
+        }
+        return true;
+    };
+    auto progress = [&](PWP_UINT32 items) {
+        return adsData.progress().incr(items);
+    };
+    adsParallelFor(total, MTChunkSize, adsData.getWriterThreads(), work,
+        progress);
+    return bad;
+}
+
+
+// The BC face records PwModStreamFaces() gives for the model. The validator
+// compares them with the REST file, so they are made without the cell type
+// cache or the face hash the writers may have used.
+struct BcFaceList {
+    BcFaceList(CAEP_RTITEM &rti) :
+        rti(rti),
+        recs()
+    {
+    }
+
+    CAEP_RTITEM &           rti;
+    std::vector<PWP_UINT32> recs;
+};
+
+
+PWP_UINT32 listBeginCB(PWGM_BEGINSTREAM_DATA *data)
+{
+    BcFaceList &list = *((BcFaceList*)data->userData);
+    list.recs.reserve(size_t(data->totalNumFaces) * BcFaceBatch::RecSize);
+    return 1;
+}
+
+
+PWP_UINT32 listFaceCB(PWGM_FACESTREAM_DATA *data)
+{
+    BcFaceList &list = *((BcFaceList*)data->userData);
+    const ADSData &adsData = *list.rti.adsData;
+    PWGM_ELEMDATA eData;
+    if (!PwElemDataMod(data->owner.blockElem, &eData)) {
+        return 0;
+    }
+    list.recs.push_back(adsData.restCell(data->owner.cellIndex) + 1);
+    list.recs.push_back(fixFace(eData.type, data->owner.cellFaceIndex));
+    list.recs.push_back(adsData.getCDtid(data->owner.domain));
+    return list.rti.adsData->progress().incr();
+}
+
+
+PWP_UINT32 listEndCB(PWGM_ENDSTREAM_DATA *data)
+{
+    return data->ok;
+}
+
+
+// Maps the binary REST file and checks it against the model:
+// - the header values;
+// - the XYZ of each vertex, compared with the model vertex at the vertex
+//   order and the export precision, and the zero values after them;
+// - the connectivity index ranges;
+// - each boundary face record, compared with the owner cell, ADS face id
+//   and CD tid from PwModStreamFaces().
+// Sends an error for the first problem found and returns false.
+static bool
+validateRestFile(CAEP_RTITEM &rti)
+{
+    ADSData &adsData = *rti.adsData;
+    if (!adsData.useValidation()) {
+        return true;
+    }
+    ADSStageStats &stats = adsData.stats();
+    stats.begin(ADSStageStats::Validate);
+    ADSRestReader rest;
+    std::ostringstream msg;
+    if (!rest.open(fileName(rti, "REST").c_str(), adsData.getIndexSize(),
+            vertexValueSize(rti))) {
+        msg << rest.error();
+    }
+
+    // the header values written by writeHeader()
+    PWP_UINT64 header[ADSRestReader::HeaderRecords]
+        [ADSRestReader::HeaderValues] = { { 0 } };
+    header[0][0] = 1; // NSECTIONS
+    header[0][2] = adsData.getNDVAR(); // NDVAR
+    header[0][6] = adsData.getBlockCount(); // NBK
+    header[2][0] = adsData.getVertexCount(); // NNL
+    header[2][1] = adsData.getElementCount(); // NEL
+    header[2][2] = adsData.getBoundaryFaceCount(); // NBCL
+    header[2][4] = adsData.getNDVAR(); // NCDUT
+    for (int r = 0; msg.str().empty() && r < ADSRestReader::HeaderRecords;
+            ++r) {
+        for (int i = 0; i < ADSRestReader::HeaderValues; ++i) {
+            if (rest.getHeader(r, i) != header[r][i]) {
+                msg << "REST header record " << (r + 1) << " value " <<
+                    (i + 1) << " is " << rest.getHeader(r, i) <<
+                    " instead of " << header[r][i];
+                break;
+            }
+        }
+    }
+
+    const PWP_UINT32 nnl = adsData.getVertexCount();
+    const PWP_UINT32 nel = adsData.getElementCount();
+    const PWP_UINT32 nbcl = adsData.getBoundaryFaceCount();
+    const bool single = (sizeof(float) == vertexValueSize(rti));
+    auto vertexOk = [&](PWP_UINT32 v) {
+        PWGM_VERTDATA vData;
+        if (!PwVertDataMod(PwModEnumVertices(rti.model,
+                adsData.modelVertex(v)), &vData)) {
+            return false;
+        }
+        const PWP_REAL xyz[3] = { vData.x, vData.y, vData.z };
+        for (size_t j = 0; j < rest.getVertexValueCount(); ++j) {
+            const double val = rest.vertexValue(v, j);
+            // XYZ are the model's at the export precision and the values
+            // after them are 0
+            const double want = (j >= 3) ? 0.0 : single ?
+                double(float(xyz[j])) : double(xyz[j]);
+            if (val != want) {
+                return false;
+            }
+        }
+        return true;
+    };
+    auto elemOk = [&](PWP_UINT32 e) {
+        PWP_UINT64 ndx[ADSRestReader::ElemValues];
+        for (size_t j = 0; j < ADSRestReader::ElemValues; ++j) {
+            ndx[j] = rest.elemValue(e, j);
+            if (ndx[j] < 1 || ndx[j] > nnl) {
+                return false;
+            }
+        }
+        // the last vertex is repeated to fill out the record
+        PWGM_ENUM_ELEMTYPE eType;
+        if (adsData.getCellType(adsData.modelCell(e), eType)) {
+            const PWP_UINT32 vertCnt = ElemVertCnts[eType];
+            for (size_t j = vertCnt; j < ADSRestReader::ElemValues; ++j) {
+                if (ndx[j] != ndx[vertCnt - 1]) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    };
+    BcFaceList faces(rti);
+    auto bcFaceOk = [&](PWP_UINT32 f) {
+        const PWP_UINT32 *want = &faces.recs[size_t(f) *
+            BcFaceBatch::RecSize];
+        for (size_t j = 0; j < BcFaceBatch::RecSize; ++j) {
+            if (rest.bcValue(f, j) != want[j]) {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    bool ret = msg.str().empty();
+    // the faces are streamed and then checked
+    if (ret && adsData.progress().beginStep(PWP_UINT64(nnl) + nel +
+            2 * PWP_UINT64(nbcl))) {
+        PWP_UINT32 bad;
+        if (!PwModStreamFaces(rti.model, PWGM_FACEORDER_BCGROUPSONLY,
+                listBeginCB, listFaceCB, listEndCB, &faces)) {
+            if (!adsData.progress().aborted()) {
+                msg << "Could not stream the boundary faces of the model";
+            }
+        }
+        else if (faces.recs.size() != size_t(nbcl) * BcFaceBatch::RecSize) {
+            msg << "The model streamed " << (faces.recs.size() /
+                BcFaceBatch::RecSize) << " boundary faces instead of " <<
+                nbcl;
+        }
+        else if (nnl != (bad = findBadRecord(rti, nnl, vertexOk))) {
+            msg << "REST vertex record " << (bad + 1) << " does not match "
+                "the model XYZ or has a non-zero dependent variable";
+        }
+        else if (nel != (bad = findBadRecord(rti, nel, elemOk))) {
+            msg << "REST connectivity record " << (bad + 1) << " has a "
+                "vertex index out of range or bad padding";
+        }
+        else if (nbcl != (bad = findBadRecord(rti, nbcl, bcFaceOk))) {
+            const PWP_UINT32 *want = &faces.recs[size_t(bad) *
+                BcFaceBatch::RecSize];
+            msg << "REST boundary face record " << (bad + 1) << " is (" <<
+                rest.bcValue(bad, 0) << " " << rest.bcValue(bad, 1) << " " <<
+                rest.bcValue(bad, 2) << ") instead of the model's (" <<
+                want[0] << " " << want[1] << " " << want[2] << ")";
+        }
+        ret = msg.str().empty();
+    }
+    adsData.progress().endStep();
+    // a vertex fetch is 2 calls and a face is 1 plus the stream call
+    stats.end(ADSStageStats::Validate, rest.fileSize(),
+        PWP_UINT64(nnl) + nel + nbcl, 2 * PWP_UINT64(nnl) + nbcl + 1);
+
+    if (adsData.progress().aborted()) {
+        ret = false;
+    }
+    else if (!ret) {
+        msg << "!";
+        caeuSendErrorMsg(&rti, msg.str().c_str(), 0);
+    }
+    else {
+        caeuSendInfoMsg(&rti, "REST file validated.", 0);
+    }
+    return ret;
+}
+
+
+typedef bool (*ExportBcFunc)(const ADSData &adsData, FILE *fp);
+
+// Writes an ASCII BC file through its own file handle. The BC data comes
+// from ADSData and no grid model calls are made, so this is safe to run on
+// another thread while the REST file is written.
 static bool
-writeBcTypeFile(CAEP_RTITEM &rti)
+writeBcFile(CAEP_RTITEM &rti, const char *ext, ExportBcFunc exportFunc,
+    ADSStageStats::Stage stage)
 {
-    bool ret = openFile(rti, "BCTYPE", PWP_ENCODING_ASCII);
+    FILE *fp = pwpFileOpen(fileName(rti, ext).c_str(), pwpWrite | pwpAscii);
+    bool ret = (0 != fp);
     if (ret) {
-        ret = exportBCTYPE(rti);
-        closeFile(rti);
+        ADSStageStats &stats = rti.adsData->stats();
+        stats.begin(stage);
+        ret = exportFunc(*rti.adsData, fp);
+        stats.end(stage, PWP_UINT64(ftell(fp)), rti.adsData->getBcCount(), 0);
+        ret = (0 == pwpFileClose(fp)) && ret;
     }
-    return ret && !CAEPU_RT_IS_ABORTED(&rti);
+    return ret;
+}
+
+
+// The REST file is written on this thread while the BCVAL and BCTYPE files
+// are written on their own threads.
+static bool
+writeFiles(CAEP_RTITEM &rti)
+{
+    bool bcValOk = false;
+    bool bcTypeOk = false;
+    std::thread bcValThread([&]() {
+        bcValOk = writeBcFile(rti, "BCVAL", exportBCVAL,
+            ADSStageStats::BcVal);
+    });
+    std::thread bcTypeThread([&]() {
+        bcTypeOk = writeBcFile(rti, "BCTYPE", exportBCTYPE,
+            ADSStageStats::BcType);
+    });
+    const bool restOk = writeRestFile(rti) && validateRestFile(rti);
+    bcValThread.join();
+    bcTypeThread.join();
+
+    if (!bcValOk) {
+        caeuSendErrorMsg(&rti, "Could not write BCVAL file!", 0);
+    }
+    if (!bcTypeOk) {
+        caeuSendErrorMsg(&rti, "Could not write BCTYPE file!", 0);
+    }
+    if (!restOk) {
+        // A failed or aborted export leaves no BC files behind
+        pwpFileDelete(fileName(rti, "BCVAL").c_str());
+        pwpFileDelete(fileName(rti, "BCTYPE").c_str());
+    }
+    return restOk && bcValOk && bcTypeOk && !CAEPU_RT_IS_ABORTED(&rti);
 }
 
 
@@ -748,6 +3790,31 @@ doStartup(CAEP_RTITEM &rti)
 }
 
 
+// Sends the stage statistics as info messages and, if requested, writes
+// them to a JSON file next to the REST file.
+static bool
+reportStats(CAEP_RTITEM &rti)
+{
+    const ADSStageStats &stats = rti.adsData->stats();
+    if (stats.enabled()) {
+        const std::string kernels = std::string("Record kernels: ") +
+            adsSimdName(adsSimdLevel());
+        caeuSendInfoMsg(&rti, kernels.c_str(), 0);
+        for (int i = 0; i < ADSStageStats::NumStages; ++i) {
+            const ADSStageStats::Stage s = ADSStageStats::Stage(i);
+            if (stats.get(s).done) {
+                caeuSendInfoMsg(&rti, stats.format(s).c_str(), 0);
+            }
+        }
+        if (rti.adsData->writeStatsJson() &&
+                !stats.writeJson(fileName(rti, "stats.json").c_str())) {
+            caeuSendWarningMsg(&rti, "Could not write stage stats file!", 0);
+        }
+    }
+    return true;
+}
+
+
 static bool
 doCleanup(CAEP_RTITEM &rti)
 {
@@ -761,9 +3828,9 @@ runtimeWrite( CAEP_RTITEM *pRti, PWGM_HGRIDMODEL /*model*/,
     const CAEP_WRITEINFO * /*pWriteInfo*/)
 {
     ADSData adsData(*pRti);
-    return doStartup(*pRti) && adsData.init() && caeuProgressInit(pRti, 3) &&
-        writeRestFile(*pRti) && writeBcValFile(*pRti) &&
-        writeBcTypeFile(*pRti) && doCleanup(*pRti);
+    return doStartup(*pRti) && adsData.init() &&
+        caeuProgressInit(pRti, adsData.getProgressStepCount()) &&
+        writeFiles(*pRti) && reportStats(*pRti) && doCleanup(*pRti);
 }
 
 